@@ -0,0 +1,443 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+#include "implicit-treap.h"
+
+// sequence container that maintains a monoid summary of its elements
+// and answers range aggregate queries, nodes form an implicit treap
+// ordered by position
+//
+// Monoid has to provide
+//   using value_type = ...;
+//   static value_type identity();
+//   static value_type of(T const&);
+//   static value_type combine(value_type const&, value_type const&);
+// combine has to be associative, none of them may throw
+//
+// elements are only accessible for reading, assign() replaces one
+template <typename T, typename Monoid>
+class augmented_list {
+private:
+  struct list_iterator;
+
+  struct node;
+  struct data_node;
+
+  using tree = implicit_treap<node>;
+
+  tree tree_;
+
+public:
+  using summary_type = typename Monoid::value_type;
+
+  // bidirectional iterator
+  using const_iterator = list_iterator;
+  using iterator = const_iterator;
+
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reverse_iterator = const_reverse_iterator;
+
+  // O(1)
+  augmented_list() noexcept;
+
+  // O(n log n), strong
+  augmented_list(augmented_list const&);
+
+  // O(n log n), strong
+  augmented_list& operator=(augmented_list const&);
+
+  // O(1)
+  augmented_list(augmented_list&&) noexcept;
+
+  // O(n)
+  augmented_list& operator=(augmented_list&&) noexcept;
+
+  // O(n)
+  ~augmented_list();
+
+  // O(1)
+  bool empty() const noexcept;
+  // O(1)
+  std::size_t size() const noexcept;
+
+  // O(log n)
+  T const& front() const noexcept;
+  // O(log n)
+  T const& back() const noexcept;
+
+  // O(log n), strong
+  void push_front(T const&);
+  // O(log n)
+  void pop_front() noexcept;
+  // O(log n), strong
+  void push_back(T const&);
+  // O(log n)
+  void pop_back() noexcept;
+
+  // O(log n)
+  const_iterator begin() const noexcept;
+  // O(1)
+  const_iterator end() const noexcept;
+
+  // O(1)
+  const_reverse_iterator rbegin() const noexcept;
+  // O(log n)
+  const_reverse_iterator rend() const noexcept;
+
+  // O(n)
+  void clear() noexcept;
+
+  // O(log n)
+  // i == size() gives end()
+  const_iterator nth(std::size_t i) const noexcept;
+  // O(log n)
+  std::size_t index_of(const_iterator pos) const noexcept;
+
+  // O(1)
+  // summary of all elements
+  summary_type aggregate() const;
+  // O(log n)
+  // summary of [first, last)
+  summary_type aggregate(const_iterator first, const_iterator last) const;
+
+  // O(log n), basic
+  void assign(const_iterator pos, T const& val);
+
+  // O(log n), strong
+  iterator insert(const_iterator pos, T const& val);
+  // O(log n)
+  iterator erase(const_iterator pos) noexcept;
+  // O(log n + (last - first))
+  iterator erase(const_iterator first, const_iterator last) noexcept;
+  // O(log n)
+  // pos must not be in [first, last)
+  void splice(const_iterator pos, augmented_list& other, const_iterator first,
+              const_iterator last) noexcept;
+
+  friend void swap(augmented_list& a, augmented_list& b) noexcept {
+    a.swap(b);
+  }
+
+private:
+  void swap(augmented_list& other) noexcept;
+  // summary of the elements with positions [first, last)
+  summary_type fold(std::size_t first, std::size_t last) const;
+
+  struct list_iterator {
+  private:
+    node* ptr_{nullptr};
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = T const;
+    using pointer = T const*;
+    using reference = T const&;
+
+    list_iterator() = default;
+
+    reference operator*() const {
+      return ptr_->value();
+    }
+    pointer operator->() const {
+      return &ptr_->value();
+    }
+
+    list_iterator& operator++() & {
+      ptr_ = tree::successor(ptr_);
+      return *this;
+    }
+
+    list_iterator operator++(int) & {
+      list_iterator old = *this;
+      ++(*this);
+      return old;
+    }
+
+    list_iterator& operator--() & {
+      ptr_ = tree::predecessor(ptr_);
+      return *this;
+    }
+
+    list_iterator operator--(int) & {
+      list_iterator old = *this;
+      --(*this);
+      return old;
+    }
+
+    bool operator==(list_iterator const& other) const {
+      return ptr_ == other.ptr_;
+    }
+
+    bool operator!=(list_iterator const& other) const {
+      return ptr_ != other.ptr_;
+    }
+
+  private:
+    explicit list_iterator(node* ptr) : ptr_(ptr) {}
+
+    friend augmented_list;
+  };
+};
+
+template <typename T, typename Monoid>
+struct augmented_list<T, Monoid>::node : treap_node<node> {
+  node() = default;
+
+  T& value();
+
+  void recompute(node const* left, node const* right) noexcept;
+  static void destroy(node* cur) noexcept;
+
+private:
+  // summary of the subtree
+  summary_type summary_{Monoid::identity()};
+
+  friend augmented_list;
+};
+
+template <typename T, typename Monoid>
+struct augmented_list<T, Monoid>::data_node : node {
+  explicit data_node(T const& value);
+
+private:
+  T value_;
+
+  friend node;
+  friend augmented_list;
+};
+
+template <typename T, typename Monoid>
+augmented_list<T, Monoid>::augmented_list() noexcept : tree_() {}
+
+template <typename T, typename Monoid>
+augmented_list<T, Monoid>::augmented_list(augmented_list const& other)
+    : augmented_list() {
+  for (T const& val : other) {
+    push_back(val);
+  }
+}
+
+template <typename T, typename Monoid>
+augmented_list<T, Monoid>&
+augmented_list<T, Monoid>::operator=(augmented_list const& other) {
+  if (this != &other) {
+    augmented_list(other).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T, typename Monoid>
+augmented_list<T, Monoid>::augmented_list(augmented_list&& other) noexcept
+    : augmented_list() {
+  swap(other);
+}
+
+template <typename T, typename Monoid>
+augmented_list<T, Monoid>&
+augmented_list<T, Monoid>::operator=(augmented_list&& other) noexcept {
+  if (this != &other) {
+    augmented_list(std::move(other)).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T, typename Monoid>
+augmented_list<T, Monoid>::~augmented_list() = default;
+
+template <typename T, typename Monoid>
+bool augmented_list<T, Monoid>::empty() const noexcept {
+  return tree_.empty();
+}
+
+template <typename T, typename Monoid>
+std::size_t augmented_list<T, Monoid>::size() const noexcept {
+  return tree_.size();
+}
+
+template <typename T, typename Monoid>
+T const& augmented_list<T, Monoid>::front() const noexcept {
+  return *begin();
+}
+
+template <typename T, typename Monoid>
+T const& augmented_list<T, Monoid>::back() const noexcept {
+  return *std::prev(end());
+}
+
+template <typename T, typename Monoid>
+void augmented_list<T, Monoid>::push_front(T const& val) {
+  insert(begin(), val);
+}
+
+template <typename T, typename Monoid>
+void augmented_list<T, Monoid>::pop_front() noexcept {
+  erase(begin());
+}
+
+template <typename T, typename Monoid>
+void augmented_list<T, Monoid>::push_back(T const& val) {
+  insert(end(), val);
+}
+
+template <typename T, typename Monoid>
+void augmented_list<T, Monoid>::pop_back() noexcept {
+  erase(std::prev(end()));
+}
+
+template <typename T, typename Monoid>
+typename augmented_list<T, Monoid>::const_iterator
+augmented_list<T, Monoid>::begin() const noexcept {
+  return const_iterator(tree_.first());
+}
+
+template <typename T, typename Monoid>
+typename augmented_list<T, Monoid>::const_iterator
+augmented_list<T, Monoid>::end() const noexcept {
+  return const_iterator(tree_.header());
+}
+
+template <typename T, typename Monoid>
+typename augmented_list<T, Monoid>::const_reverse_iterator
+augmented_list<T, Monoid>::rbegin() const noexcept {
+  return const_reverse_iterator(end());
+}
+
+template <typename T, typename Monoid>
+typename augmented_list<T, Monoid>::const_reverse_iterator
+augmented_list<T, Monoid>::rend() const noexcept {
+  return const_reverse_iterator(begin());
+}
+
+template <typename T, typename Monoid>
+void augmented_list<T, Monoid>::clear() noexcept {
+  tree_.clear();
+}
+
+template <typename T, typename Monoid>
+typename augmented_list<T, Monoid>::const_iterator
+augmented_list<T, Monoid>::nth(std::size_t i) const noexcept {
+  return const_iterator(tree_.nth(i));
+}
+
+template <typename T, typename Monoid>
+std::size_t
+augmented_list<T, Monoid>::index_of(const_iterator pos) const noexcept {
+  return tree_.index_of(pos.ptr_);
+}
+
+template <typename T, typename Monoid>
+typename augmented_list<T, Monoid>::summary_type
+augmented_list<T, Monoid>::aggregate() const {
+  return fold(0, size());
+}
+
+template <typename T, typename Monoid>
+typename augmented_list<T, Monoid>::summary_type
+augmented_list<T, Monoid>::aggregate(const_iterator first,
+                                     const_iterator last) const {
+  return fold(index_of(first), index_of(last));
+}
+
+template <typename T, typename Monoid>
+void augmented_list<T, Monoid>::assign(const_iterator pos, T const& val) {
+  node* cur = pos.ptr_;
+  try {
+    cur->value() = val;
+  } catch (...) {
+    // the element may be partially assigned, summaries have to match it
+    tree_.refresh(cur);
+    throw;
+  }
+  tree_.refresh(cur);
+}
+
+template <typename T, typename Monoid>
+typename augmented_list<T, Monoid>::iterator
+augmented_list<T, Monoid>::insert(const_iterator pos, T const& val) {
+  node* new_node = new data_node(val);
+  tree_.insert_before(pos.ptr_, new_node);
+  return iterator(new_node);
+}
+
+template <typename T, typename Monoid>
+typename augmented_list<T, Monoid>::iterator
+augmented_list<T, Monoid>::erase(const_iterator pos) noexcept {
+  node* cur = pos.ptr_;
+  node* next = tree::successor(cur);
+  tree_.erase(cur);
+  node::destroy(cur);
+  return iterator(next);
+}
+
+template <typename T, typename Monoid>
+typename augmented_list<T, Monoid>::iterator
+augmented_list<T, Monoid>::erase(const_iterator first,
+                                 const_iterator last) noexcept {
+  if (first != last) {
+    tree::destroy_tree(tree_.cut(index_of(first), index_of(last)));
+  }
+  return iterator(last.ptr_);
+}
+
+template <typename T, typename Monoid>
+void augmented_list<T, Monoid>::splice(const_iterator pos,
+                                       augmented_list& other,
+                                       const_iterator first,
+                                       const_iterator last) noexcept {
+  if (first == last) {
+    return;
+  }
+  node* range = other.tree_.cut(other.index_of(first), other.index_of(last));
+  // pos keeps its node, its rank is taken after the range is cut out
+  tree_.paste(index_of(pos), range);
+}
+
+template <typename T, typename Monoid>
+void augmented_list<T, Monoid>::swap(augmented_list& other) noexcept {
+  tree_.swap(other.tree_);
+}
+
+template <typename T, typename Monoid>
+typename augmented_list<T, Monoid>::summary_type
+augmented_list<T, Monoid>::fold(std::size_t first, std::size_t last) const {
+  summary_type res = Monoid::identity();
+  tree_.decompose(
+      first, last,
+      [&res](node const* subtree) {
+        res = Monoid::combine(res, subtree->summary_);
+      },
+      [&res](node const* single) {
+        res = Monoid::combine(
+            res, Monoid::of(static_cast<data_node const*>(single)->value_));
+      });
+  return res;
+}
+
+template <typename T, typename Monoid>
+T& augmented_list<T, Monoid>::node::value() {
+  return static_cast<data_node*>(this)->value_;
+}
+
+template <typename T, typename Monoid>
+void augmented_list<T, Monoid>::node::recompute(node const* left,
+                                                node const* right) noexcept {
+  summary_ = Monoid::of(static_cast<data_node*>(this)->value_);
+  if (left) {
+    summary_ = Monoid::combine(left->summary_, summary_);
+  }
+  if (right) {
+    summary_ = Monoid::combine(summary_, right->summary_);
+  }
+}
+
+template <typename T, typename Monoid>
+void augmented_list<T, Monoid>::node::destroy(node* cur) noexcept {
+  delete static_cast<data_node*>(cur);
+}
+
+template <typename T, typename Monoid>
+augmented_list<T, Monoid>::data_node::data_node(T const& value)
+    : value_(value) {}
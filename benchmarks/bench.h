@@ -0,0 +1,68 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "../list.h"
+
+namespace bench {
+
+// keeps the compiler from dropping the computation of value, safe to
+// call from several threads
+template <typename T>
+void keep(T value) {
+  thread_local volatile T sink;
+  sink = value;
+  static_cast<void>(sink);
+}
+
+// best wall time of runs calls of f, in nanoseconds
+template <typename F>
+double best_of(std::size_t runs, F f) {
+  double best = std::numeric_limits<double>::infinity();
+  for (std::size_t i = 0; i < runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::nano> time =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, time.count());
+  }
+  return best;
+}
+
+// first command line argument or fallback, scales the problem sizes
+inline std::size_t scale(int argc, char** argv, std::size_t fallback) {
+  return argc > 1 ? std::strtoull(argv[1], nullptr, 10) : fallback;
+}
+
+// swaps the positions of random pairs of nodes until about fraction of
+// them sit away from their allocation order, nodes are allocated in
+// list order, so this controls how often a step lands on a cold line
+template <typename T>
+void fragment(list<T>& c, double fraction, std::mt19937& rng) {
+  std::vector<typename list<T>::iterator> nodes;
+  for (auto it = c.begin(); it != c.end(); ++it) {
+    nodes.push_back(it);
+  }
+  if (nodes.size() < 2) {
+    return;
+  }
+  std::uniform_int_distribution<std::size_t> pick(0, nodes.size() - 1);
+  auto swaps = static_cast<std::size_t>(fraction * nodes.size() / 2);
+  for (std::size_t i = 0; i < swaps; ++i) {
+    auto a = nodes[pick(rng)];
+    auto b = nodes[pick(rng)];
+    auto after_a = std::next(a);
+    if (a == b || after_a == b) {
+      continue;
+    }
+    c.splice(b, c, a, after_a);
+    c.splice(after_a, c, b, std::next(b));
+  }
+}
+
+} // namespace bench
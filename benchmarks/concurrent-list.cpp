@@ -0,0 +1,127 @@
+// mixed workload on one shared list of long: a read sums all elements,
+// a write appends an element and erases the oldest one the same thread
+// appended, run by 1 to 64 threads against concurrent_list and against
+// a list behind one std::mutex
+//
+// usage: bench-concurrent-list [operations per run]
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../concurrent-list.h"
+#include "bench.h"
+
+namespace {
+
+class locked_list {
+public:
+  using handle = list<long>::iterator;
+
+  handle insert(long val) {
+    std::lock_guard<std::mutex> lock(m_);
+    return c_.insert(c_.end(), val);
+  }
+
+  void erase(handle pos) {
+    std::lock_guard<std::mutex> lock(m_);
+    c_.erase(pos);
+  }
+
+  long sum() {
+    std::lock_guard<std::mutex> lock(m_);
+    long res = 0;
+    for (long x : c_) {
+      res += x;
+    }
+    return res;
+  }
+
+private:
+  std::mutex m_;
+  list<long> c_;
+};
+
+class fine_grained_list {
+public:
+  using handle = concurrent_list<long>::iterator;
+
+  handle insert(long val) {
+    return c_.insert(c_.end(), val);
+  }
+
+  void erase(handle pos) {
+    c_.erase(pos);
+  }
+
+  long sum() {
+    long res = 0;
+    c_.for_each([&res](long x) { res += x; });
+    return res;
+  }
+
+private:
+  concurrent_list<long> c_;
+};
+
+constexpr std::size_t initial_size = 256;
+// elements each thread keeps appended before it starts erasing them
+constexpr std::size_t owned = 8;
+
+template <typename List>
+void run(std::size_t threads, std::size_t operations, double reads) {
+  List c;
+  std::vector<typename List::handle> initial;
+  for (std::size_t i = 0; i < initial_size; ++i) {
+    initial.push_back(c.insert(static_cast<long>(i)));
+  }
+
+  std::vector<std::thread> workers;
+  for (std::size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&c, t, reads, operations = operations / threads] {
+      std::mt19937 rng(static_cast<unsigned>(t));
+      std::bernoulli_distribution is_read(reads);
+      std::deque<typename List::handle> mine;
+      long sum = 0;
+      for (std::size_t i = 0; i < operations; ++i) {
+        if (is_read(rng)) {
+          sum += c.sum();
+          continue;
+        }
+        mine.push_back(c.insert(static_cast<long>(i)));
+        if (mine.size() > owned) {
+          c.erase(mine.front());
+          mine.pop_front();
+        }
+      }
+      for (auto const& pos : mine) {
+        c.erase(pos);
+      }
+      bench::keep(sum);
+    });
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t operations = bench::scale(argc, argv, std::size_t(1) << 16);
+  std::printf("%5s %7s | %9s %9s   operations per microsecond\n", "reads",
+              "threads", "mutex", "per node");
+  for (double reads : {0.5, 0.9, 0.99}) {
+    for (std::size_t threads = 1; threads <= 64; threads *= 2) {
+      double n = static_cast<double>(operations / threads * threads);
+      double locked = bench::best_of(
+          3, [&] { run<locked_list>(threads, operations, reads); });
+      double fine_grained = bench::best_of(
+          3, [&] { run<fine_grained_list>(threads, operations, reads); });
+      std::printf("%4.0f%% %7zu | %9.2f %9.2f\n", reads * 100, threads,
+                  n / locked * 1000, n / fine_grained * 1000);
+    }
+  }
+}
@@ -0,0 +1,51 @@
+// scans of many short lists of long, like the chains of a hash table,
+// one list after another with begin()..end() loops and round-robin with
+// for_each_interleaved for several group sizes, elements are appended to
+// random lists so that neighbouring nodes of a list are far apart
+//
+// usage: bench-interleaved [total number of elements]
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+
+int main(int argc, char** argv) {
+  std::size_t total = bench::scale(argc, argv, std::size_t(1) << 22);
+  std::mt19937 rng(42);
+  std::size_t const groups[] = {2, 4, 8, 16, 32};
+  std::printf("%8s %8s | %10s", "length", "lists", "sequential");
+  for (std::size_t group : groups) {
+    std::printf(" %8s%-2zu", "group ", group);
+  }
+  std::printf("   ns/element\n");
+  for (std::size_t length : {2, 8, 32, 128}) {
+    std::vector<list<long>> lists(total / length);
+    std::uniform_int_distribution<std::size_t> pick(0, lists.size() - 1);
+    for (std::size_t i = 0; i < total; ++i) {
+      lists[pick(rng)].push_back(static_cast<long>(i));
+    }
+
+    double n = static_cast<double>(total);
+    double sequential = bench::best_of(5, [&] {
+      long sum = 0;
+      for (list<long> const& c : lists) {
+        for (long x : c) {
+          sum += x;
+        }
+      }
+      bench::keep(sum);
+    });
+    std::printf("%8zu %8zu | %10.2f", length, lists.size(), sequential / n);
+    for (std::size_t group : groups) {
+      double interleaved = bench::best_of(5, [&] {
+        long sum = 0;
+        list<long>::for_each_interleaved(
+            lists.begin(), lists.end(), [&sum](long x) { sum += x; }, group);
+        bench::keep(sum);
+      });
+      std::printf(" %10.2f", interleaved / n);
+    }
+    std::printf("\n");
+  }
+}
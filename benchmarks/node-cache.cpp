@@ -0,0 +1,105 @@
+// producer/consumer pairs: one thread of a pair builds lists and passes
+// them through a short queue to the other, which destroys them, with
+// nodes from the global operator new and from node_cache, for several
+// numbers of pairs running at once
+//
+// usage: bench-node-cache [elements per pair]
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+
+namespace {
+
+struct plain {
+  long key;
+  long value;
+};
+
+struct cached {
+  long key;
+  long value;
+};
+
+} // namespace
+
+template <>
+struct enable_node_cache<cached> : std::true_type {};
+
+namespace {
+
+template <typename T>
+class channel {
+public:
+  void push(list<T>&& c) {
+    std::unique_lock<std::mutex> lock(m_);
+    changed_.wait(lock, [this] { return queue_.size() < capacity; });
+    queue_.push_back(std::move(c));
+    changed_.notify_all();
+  }
+
+  list<T> pop() {
+    std::unique_lock<std::mutex> lock(m_);
+    changed_.wait(lock, [this] { return !queue_.empty(); });
+    list<T> res = std::move(queue_.front());
+    queue_.pop_front();
+    changed_.notify_all();
+    return res;
+  }
+
+private:
+  static constexpr std::size_t capacity = 4;
+
+  std::deque<list<T>> queue_;
+  std::mutex m_;
+  std::condition_variable changed_;
+};
+
+template <typename T>
+void run(std::size_t pairs, std::size_t lists, std::size_t length) {
+  std::vector<channel<T>> channels(pairs);
+  std::vector<std::thread> threads;
+  for (channel<T>& ch : channels) {
+    threads.emplace_back([&ch, lists, length] {
+      for (std::size_t i = 0; i < lists; ++i) {
+        list<T> c;
+        for (std::size_t j = 0; j < length; ++j) {
+          c.push_back({static_cast<long>(i), static_cast<long>(j)});
+        }
+        ch.push(std::move(c));
+      }
+    });
+    threads.emplace_back([&ch, lists] {
+      for (std::size_t i = 0; i < lists; ++i) {
+        ch.pop();
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t total = bench::scale(argc, argv, std::size_t(1) << 20);
+  std::printf("%6s %8s | %9s %9s   ns/element of a pair\n", "pairs",
+              "length", "new", "cache");
+  for (std::size_t pairs : {1, 2, 4, 8}) {
+    for (std::size_t length : {16, 1024}) {
+      std::size_t lists = total / length;
+      double n = static_cast<double>(lists * length);
+      double plain_time =
+          bench::best_of(3, [&] { run<plain>(pairs, lists, length); });
+      double cached_time =
+          bench::best_of(3, [&] { run<cached>(pairs, lists, length); });
+      std::printf("%6zu %8zu | %9.2f %9.2f\n", pairs, length, plain_time / n,
+                  cached_time / n);
+    }
+  }
+}
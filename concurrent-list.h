@@ -0,0 +1,304 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// list that can be modified and traversed by several threads at once,
+// every node has its own mutex
+//
+// locks are taken from left to right, a node's left neighbour is only
+// try_lock'ed and everything is released on failure, so no thread ever
+// waits for a node to the left of one it holds
+//
+// a node can only be unlinked by a thread holding it and both of its
+// neighbours, so a node stays alive while it or a neighbour is held;
+// traversal only moves hand over hand through for_each and erase_if,
+// iterators are handles to single elements that stay valid until the
+// element is erased
+template <typename T>
+class concurrent_list {
+private:
+  struct list_iterator;
+
+  struct node;
+  struct data_node;
+
+  node head_;
+  node tail_;
+
+public:
+  // handle to an element or to end(), it can't be moved, dereferencing
+  // doesn't lock the node
+  using iterator = list_iterator;
+
+  // O(1)
+  concurrent_list() noexcept;
+
+  concurrent_list(concurrent_list const&) = delete;
+  concurrent_list& operator=(concurrent_list const&) = delete;
+
+  // O(n)
+  // no other thread may access the list
+  ~concurrent_list();
+
+  // O(1)
+  bool empty() const noexcept;
+
+  // O(1)
+  // never invalidated
+  iterator end() noexcept;
+
+  // O(1), strong
+  void push_front(T const&);
+  // O(1), strong
+  void push_back(T const&);
+
+  // O(1), strong
+  // pos must not be erased concurrently
+  iterator insert(iterator pos, T const& val);
+  // O(1)
+  // pos must not be erased concurrently by another thread
+  iterator erase(iterator pos) noexcept;
+
+  // O(n)
+  // calls f on every element in order with the element's node locked,
+  // f must not access the list
+  template <typename F>
+  void for_each(F f);
+  // O(n), basic
+  // erases every element satisfying pred, pred runs like f in for_each,
+  // no other thread may hold an iterator to an element it accepts,
+  // returns the number of erased elements
+  template <typename Predicate>
+  std::size_t erase_if(Predicate pred);
+
+private:
+  static node* lock_with_left(node* cur) noexcept;
+  static void link_between(node* new_node, node* left, node* right) noexcept;
+
+  struct list_iterator {
+  private:
+    node* ptr_{nullptr};
+
+  public:
+    using value_type = T;
+    using pointer = T*;
+    using reference = T&;
+
+    list_iterator() = default;
+
+    reference operator*() const {
+      return ptr_->value();
+    }
+    pointer operator->() const {
+      return &ptr_->value();
+    }
+
+    bool operator==(list_iterator const& other) const {
+      return ptr_ == other.ptr_;
+    }
+
+    bool operator!=(list_iterator const& other) const {
+      return ptr_ != other.ptr_;
+    }
+
+  private:
+    explicit list_iterator(node* ptr) : ptr_(ptr) {}
+
+    friend concurrent_list;
+  };
+};
+
+template <typename T>
+struct concurrent_list<T>::node {
+  node() = default;
+
+  T& value();
+
+private:
+  node* left_{nullptr};
+  node* right_{nullptr};
+  // guards left_, right_ and the value
+  mutable std::mutex mutex_;
+
+  friend concurrent_list;
+};
+
+template <typename T>
+struct concurrent_list<T>::data_node : node {
+  explicit data_node(T const& value);
+
+private:
+  T value_;
+
+  friend node;
+};
+
+template <typename T>
+concurrent_list<T>::concurrent_list() noexcept : head_(), tail_() {
+  head_.right_ = &tail_;
+  tail_.left_ = &head_;
+}
+
+template <typename T>
+concurrent_list<T>::~concurrent_list() {
+  node* cur = head_.right_;
+  while (cur != &tail_) {
+    node* next = cur->right_;
+    delete static_cast<data_node*>(cur);
+    cur = next;
+  }
+}
+
+template <typename T>
+bool concurrent_list<T>::empty() const noexcept {
+  std::lock_guard<std::mutex> lock(head_.mutex_);
+  return head_.right_ == &tail_;
+}
+
+template <typename T>
+typename concurrent_list<T>::iterator concurrent_list<T>::end() noexcept {
+  return iterator(&tail_);
+}
+
+template <typename T>
+void concurrent_list<T>::push_front(T const& val) {
+  node* new_node = new data_node(val);
+  head_.mutex_.lock();
+  node* right = head_.right_;
+  right->mutex_.lock();
+  link_between(new_node, &head_, right);
+  right->mutex_.unlock();
+  head_.mutex_.unlock();
+}
+
+template <typename T>
+void concurrent_list<T>::push_back(T const& val) {
+  insert(end(), val);
+}
+
+template <typename T>
+typename concurrent_list<T>::iterator
+concurrent_list<T>::insert(iterator pos, T const& val) {
+  node* new_node = new data_node(val);
+  node* right = pos.ptr_;
+  node* left = lock_with_left(right);
+  link_between(new_node, left, right);
+  right->mutex_.unlock();
+  left->mutex_.unlock();
+  return iterator(new_node);
+}
+
+template <typename T>
+typename concurrent_list<T>::iterator
+concurrent_list<T>::erase(iterator pos) noexcept {
+  node* cur = pos.ptr_;
+  node* left = lock_with_left(cur);
+  // cur is held, so its right neighbour cannot be unlinked
+  node* right = cur->right_;
+  right->mutex_.lock();
+  left->right_ = right;
+  right->left_ = left;
+  right->mutex_.unlock();
+  cur->mutex_.unlock();
+  left->mutex_.unlock();
+  // cur is unreachable and nobody else may hold it
+  delete static_cast<data_node*>(cur);
+  return iterator(right);
+}
+
+template <typename T>
+template <typename F>
+void concurrent_list<T>::for_each(F f) {
+  node* cur = &head_;
+  cur->mutex_.lock();
+  for (;;) {
+    node* next = cur->right_;
+    next->mutex_.lock();
+    cur->mutex_.unlock();
+    cur = next;
+    if (cur == &tail_) {
+      break;
+    }
+    try {
+      f(cur->value());
+    } catch (...) {
+      cur->mutex_.unlock();
+      throw;
+    }
+  }
+  cur->mutex_.unlock();
+}
+
+template <typename T>
+template <typename Predicate>
+std::size_t concurrent_list<T>::erase_if(Predicate pred) {
+  std::size_t erased = 0;
+  // left and cur are held, cur is unlinked with its right neighbour
+  // held too, so no other thread can be waiting for it
+  node* left = &head_;
+  left->mutex_.lock();
+  node* cur = left->right_;
+  cur->mutex_.lock();
+  while (cur != &tail_) {
+    bool accepted;
+    try {
+      accepted = pred(cur->value());
+    } catch (...) {
+      cur->mutex_.unlock();
+      left->mutex_.unlock();
+      throw;
+    }
+    node* right = cur->right_;
+    right->mutex_.lock();
+    if (accepted) {
+      left->right_ = right;
+      right->left_ = left;
+      cur->mutex_.unlock();
+      delete static_cast<data_node*>(cur);
+      ++erased;
+    } else {
+      left->mutex_.unlock();
+      left = cur;
+    }
+    cur = right;
+  }
+  cur->mutex_.unlock();
+  left->mutex_.unlock();
+  return erased;
+}
+
+// locks cur and its left neighbour, returns the neighbour
+template <typename T>
+typename concurrent_list<T>::node*
+concurrent_list<T>::lock_with_left(node* cur) noexcept {
+  for (;;) {
+    cur->mutex_.lock();
+    node* left = cur->left_;
+    // going right to left, waiting here could deadlock
+    if (left->mutex_.try_lock()) {
+      return left;
+    }
+    cur->mutex_.unlock();
+    std::this_thread::yield();
+  }
+}
+
+// left and right have to be adjacent and locked
+template <typename T>
+void concurrent_list<T>::link_between(node* new_node, node* left,
+                                      node* right) noexcept {
+  new_node->left_ = left;
+  new_node->right_ = right;
+  left->right_ = new_node;
+  right->left_ = new_node;
+}
+
+template <typename T>
+T& concurrent_list<T>::node::value() {
+  return static_cast<data_node*>(this)->value_;
+}
+
+template <typename T>
+concurrent_list<T>::data_node::data_node(T const& value) : value_(value) {}
@@ -0,0 +1,434 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+template <typename Node>
+class implicit_treap;
+
+// links of a node of implicit_treap<Node>, Node derives from it and has
+// to provide
+//   void recompute(Node const* left, Node const* right) noexcept;
+//     refreshes whatever Node caches about its subtree
+//   static void destroy(Node*) noexcept;
+template <typename Node>
+struct treap_node {
+private:
+  Node* parent_{nullptr};
+  Node* left_{nullptr};
+  Node* right_{nullptr};
+  // number of elements in the subtree
+  std::size_t size_{0};
+  std::uint32_t priority_{0};
+
+  friend implicit_treap<Node>;
+};
+
+// treap ordered by position, the root is the left child of a header
+// node that stands for the position past the last element
+template <typename Node>
+class implicit_treap {
+public:
+  // O(1)
+  implicit_treap() noexcept = default;
+
+  implicit_treap(implicit_treap const&) = delete;
+  implicit_treap& operator=(implicit_treap const&) = delete;
+
+  // O(n)
+  ~implicit_treap();
+
+  // O(1)
+  Node* header() const noexcept;
+  // O(1)
+  bool empty() const noexcept;
+  // O(1)
+  std::size_t size() const noexcept;
+
+  // O(log n)
+  // header() if the tree is empty
+  Node* first() const noexcept;
+  // O(log n)
+  // i == size() gives header()
+  Node* nth(std::size_t i) const noexcept;
+  // O(log n)
+  std::size_t index_of(Node const* cur) const noexcept;
+
+  // O(log n)
+  // links new_node right before pos
+  void insert_before(Node* pos, Node* new_node) noexcept;
+  // O(log n)
+  // unlinks cur without destroying it
+  void erase(Node* cur) noexcept;
+  // O(log n)
+  // unlinks the elements with positions [first, last) as one subtree
+  Node* cut(std::size_t first, std::size_t last) noexcept;
+  // O(log n)
+  // links a subtree returned by cut() so that it starts at position i
+  void paste(std::size_t i, Node* subtree) noexcept;
+  // O(log n)
+  // recomputes cur and its ancestors after cur's data has changed
+  void refresh(Node* cur) noexcept;
+
+  // O(log n)
+  // splits [first, last) into O(log n) whole subtrees and single nodes
+  // and passes them in order to whole(Node const*) and single(Node const*)
+  template <typename Whole, typename Single>
+  void decompose(std::size_t first, std::size_t last, Whole whole,
+                 Single single) const;
+
+  // O(n)
+  void clear() noexcept;
+  // O(1)
+  void swap(implicit_treap& other) noexcept;
+
+  // O(log n)
+  static Node* successor(Node* cur) noexcept;
+  // O(log n)
+  // nullptr for the first element
+  static Node* predecessor(Node* cur) noexcept;
+  // O(n)
+  static void destroy_tree(Node* cur) noexcept;
+
+private:
+  std::uint32_t next_priority() noexcept;
+  void set_root(Node* root) noexcept;
+
+  template <typename Whole, typename Single>
+  static void decompose(Node const* cur, std::size_t first, std::size_t last,
+                        Whole& whole, Single& single);
+
+  static std::size_t size_of(Node const* cur) noexcept;
+  static void update(Node* cur) noexcept;
+  static void rotate_up(Node* cur) noexcept;
+  static std::pair<Node*, Node*> split(Node* cur, std::size_t k) noexcept;
+  static Node* merge(Node* left, Node* right) noexcept;
+  static Node* leftmost(Node* cur) noexcept;
+  static Node* rightmost(Node* cur) noexcept;
+
+  Node header_;
+  std::uint32_t seed_{2463534242u};
+};
+
+template <typename Node>
+implicit_treap<Node>::~implicit_treap() {
+  destroy_tree(header_.left_);
+}
+
+template <typename Node>
+Node* implicit_treap<Node>::header() const noexcept {
+  return const_cast<Node*>(&header_);
+}
+
+template <typename Node>
+bool implicit_treap<Node>::empty() const noexcept {
+  return !header_.left_;
+}
+
+template <typename Node>
+std::size_t implicit_treap<Node>::size() const noexcept {
+  return size_of(header_.left_);
+}
+
+template <typename Node>
+Node* implicit_treap<Node>::first() const noexcept {
+  return leftmost(header());
+}
+
+template <typename Node>
+Node* implicit_treap<Node>::nth(std::size_t i) const noexcept {
+  Node* cur = header_.left_;
+  while (cur) {
+    std::size_t left_size = size_of(cur->left_);
+    if (i < left_size) {
+      cur = cur->left_;
+    } else if (i == left_size) {
+      return cur;
+    } else {
+      i -= left_size + 1;
+      cur = cur->right_;
+    }
+  }
+  return header();
+}
+
+template <typename Node>
+std::size_t implicit_treap<Node>::index_of(Node const* cur) const noexcept {
+  if (cur == &header_) {
+    return size();
+  }
+  std::size_t res = size_of(cur->left_);
+  for (; cur->parent_ != &header_; cur = cur->parent_) {
+    if (cur == cur->parent_->right_) {
+      res += size_of(cur->parent_->left_) + 1;
+    }
+  }
+  return res;
+}
+
+template <typename Node>
+void implicit_treap<Node>::insert_before(Node* pos, Node* new_node) noexcept {
+  new_node->priority_ = next_priority();
+  new_node->size_ = 1;
+
+  // attach as the in-order predecessor of pos
+  Node* cur = pos;
+  if (cur->left_) {
+    cur = rightmost(cur->left_);
+    cur->right_ = new_node;
+  } else {
+    cur->left_ = new_node;
+  }
+  new_node->parent_ = cur;
+  update(new_node);
+  refresh(cur);
+
+  while (new_node->parent_ != &header_ &&
+         new_node->priority_ > new_node->parent_->priority_) {
+    rotate_up(new_node);
+  }
+}
+
+template <typename Node>
+void implicit_treap<Node>::erase(Node* cur) noexcept {
+  while (cur->left_ && cur->right_) {
+    rotate_up(cur->left_->priority_ > cur->right_->priority_ ? cur->left_
+                                                             : cur->right_);
+  }
+  Node* child = cur->left_ ? cur->left_ : cur->right_;
+  Node* parent = cur->parent_;
+  if (parent->left_ == cur) {
+    parent->left_ = child;
+  } else {
+    parent->right_ = child;
+  }
+  if (child) {
+    child->parent_ = parent;
+  }
+  refresh(parent);
+}
+
+template <typename Node>
+Node* implicit_treap<Node>::cut(std::size_t first, std::size_t last) noexcept {
+  auto [left, rest] = split(header_.left_, first);
+  auto [mid, right] = split(rest, last - first);
+  set_root(merge(left, right));
+  return mid;
+}
+
+template <typename Node>
+void implicit_treap<Node>::paste(std::size_t i, Node* subtree) noexcept {
+  auto [left, right] = split(header_.left_, i);
+  set_root(merge(merge(left, subtree), right));
+}
+
+template <typename Node>
+void implicit_treap<Node>::refresh(Node* cur) noexcept {
+  for (; cur != &header_; cur = cur->parent_) {
+    update(cur);
+  }
+}
+
+template <typename Node>
+template <typename Whole, typename Single>
+void implicit_treap<Node>::decompose(std::size_t first, std::size_t last,
+                                     Whole whole, Single single) const {
+  decompose(header_.left_, first, last, whole, single);
+}
+
+template <typename Node>
+void implicit_treap<Node>::clear() noexcept {
+  destroy_tree(header_.left_);
+  header_.left_ = nullptr;
+}
+
+template <typename Node>
+void implicit_treap<Node>::swap(implicit_treap& other) noexcept {
+  Node* root = header_.left_;
+  set_root(other.header_.left_);
+  other.set_root(root);
+}
+
+template <typename Node>
+Node* implicit_treap<Node>::successor(Node* cur) noexcept {
+  if (cur->right_) {
+    return leftmost(cur->right_);
+  }
+  Node* parent = cur->parent_;
+  while (cur == parent->right_) {
+    cur = parent;
+    parent = parent->parent_;
+  }
+  return parent;
+}
+
+template <typename Node>
+Node* implicit_treap<Node>::predecessor(Node* cur) noexcept {
+  if (cur->left_) {
+    return rightmost(cur->left_);
+  }
+  Node* parent = cur->parent_;
+  while (parent && cur == parent->left_) {
+    cur = parent;
+    parent = parent->parent_;
+  }
+  return parent;
+}
+
+// flattens the tree with right rotations while deleting, no recursion
+template <typename Node>
+void implicit_treap<Node>::destroy_tree(Node* cur) noexcept {
+  while (cur) {
+    if (cur->left_) {
+      Node* left = cur->left_;
+      cur->left_ = left->right_;
+      left->right_ = cur;
+      cur = left;
+    } else {
+      Node* right = cur->right_;
+      Node::destroy(cur);
+      cur = right;
+    }
+  }
+}
+
+// xorshift32, priorities only need to be independent of positions
+template <typename Node>
+std::uint32_t implicit_treap<Node>::next_priority() noexcept {
+  seed_ ^= seed_ << 13;
+  seed_ ^= seed_ >> 17;
+  seed_ ^= seed_ << 5;
+  return seed_;
+}
+
+template <typename Node>
+void implicit_treap<Node>::set_root(Node* root) noexcept {
+  header_.left_ = root;
+  if (root) {
+    root->parent_ = &header_;
+  }
+}
+
+template <typename Node>
+template <typename Whole, typename Single>
+void implicit_treap<Node>::decompose(Node const* cur, std::size_t first,
+                                     std::size_t last, Whole& whole,
+                                     Single& single) {
+  if (!cur || first >= last) {
+    return;
+  }
+  if (first == 0 && last >= cur->size_) {
+    whole(cur);
+    return;
+  }
+  std::size_t left_size = size_of(cur->left_);
+  decompose(cur->left_, first, std::min(last, left_size), whole, single);
+  if (first <= left_size && left_size < last) {
+    single(cur);
+  }
+  if (last > left_size + 1) {
+    decompose(cur->right_, std::max(first, left_size + 1) - left_size - 1,
+              last - left_size - 1, whole, single);
+  }
+}
+
+template <typename Node>
+std::size_t implicit_treap<Node>::size_of(Node const* cur) noexcept {
+  return cur ? cur->size_ : 0;
+}
+
+// recomputes cur from its children and adopts them
+template <typename Node>
+void implicit_treap<Node>::update(Node* cur) noexcept {
+  cur->size_ = size_of(cur->left_) + size_of(cur->right_) + 1;
+  if (cur->left_) {
+    cur->left_->parent_ = cur;
+  }
+  if (cur->right_) {
+    cur->right_->parent_ = cur;
+  }
+  cur->recompute(cur->left_, cur->right_);
+}
+
+// moves cur one level up keeping the in-order sequence
+template <typename Node>
+void implicit_treap<Node>::rotate_up(Node* cur) noexcept {
+  Node* parent = cur->parent_;
+  Node* grand = parent->parent_;
+  if (cur == parent->left_) {
+    parent->left_ = cur->right_;
+    cur->right_ = parent;
+  } else {
+    parent->right_ = cur->left_;
+    cur->left_ = parent;
+  }
+  cur->parent_ = grand;
+  if (grand->left_ == parent) {
+    grand->left_ = cur;
+  } else {
+    grand->right_ = cur;
+  }
+  update(parent);
+  update(cur);
+}
+
+// cuts the first k elements of the subtree off, returns both roots
+template <typename Node>
+std::pair<Node*, Node*> implicit_treap<Node>::split(Node* cur,
+                                                    std::size_t k) noexcept {
+  if (!cur) {
+    return {nullptr, nullptr};
+  }
+  std::size_t left_size = size_of(cur->left_);
+  if (k <= left_size) {
+    auto [left, right] = split(cur->left_, k);
+    cur->left_ = right;
+    update(cur);
+    if (left) {
+      left->parent_ = nullptr;
+    }
+    return {left, cur};
+  }
+  auto [left, right] = split(cur->right_, k - left_size - 1);
+  cur->right_ = left;
+  update(cur);
+  if (right) {
+    right->parent_ = nullptr;
+  }
+  return {cur, right};
+}
+
+template <typename Node>
+Node* implicit_treap<Node>::merge(Node* left, Node* right) noexcept {
+  if (!left) {
+    return right;
+  }
+  if (!right) {
+    return left;
+  }
+  if (left->priority_ > right->priority_) {
+    left->right_ = merge(left->right_, right);
+    update(left);
+    return left;
+  }
+  right->left_ = merge(left, right->left_);
+  update(right);
+  return right;
+}
+
+template <typename Node>
+Node* implicit_treap<Node>::leftmost(Node* cur) noexcept {
+  while (cur->left_) {
+    cur = cur->left_;
+  }
+  return cur;
+}
+
+template <typename Node>
+Node* implicit_treap<Node>::rightmost(Node* cur) noexcept {
+  while (cur->right_) {
+    cur = cur->right_;
+  }
+  return cur;
+}
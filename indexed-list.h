@@ -0,0 +1,491 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+#include "implicit-treap.h"
+
+// sequence container with list-like iterator guarantees and O(log n)
+// positional access, nodes form an implicit treap ordered by position
+// and carry order-maintenance labels for O(1) order queries
+template <typename T>
+class indexed_list {
+private:
+  template <typename VALUE_TYPE>
+  struct list_iterator;
+
+  struct node;
+  struct data_node;
+
+  using tree = implicit_treap<node>;
+
+  tree tree_;
+
+public:
+  // bidirectional iterator
+  using iterator = list_iterator<T>;
+  // bidirectional iterator
+  using const_iterator = list_iterator<T const>;
+
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // O(1)
+  indexed_list() noexcept;
+
+  // O(n log n), strong
+  indexed_list(indexed_list const&);
+
+  // O(n log n), strong
+  indexed_list& operator=(indexed_list const&);
+
+  // O(1)
+  indexed_list(indexed_list&&) noexcept;
+
+  // O(n)
+  indexed_list& operator=(indexed_list&&) noexcept;
+
+  // O(n)
+  ~indexed_list();
+
+  // O(1)
+  bool empty() const noexcept;
+  // O(1)
+  std::size_t size() const noexcept;
+
+  // O(log n)
+  T& front() noexcept;
+  // O(log n)
+  T const& front() const noexcept;
+
+  // O(log n) amortized, strong
+  void push_front(T const&);
+  // O(log n)
+  void pop_front() noexcept;
+
+  // O(log n)
+  T& back() noexcept;
+  // O(log n)
+  T const& back() const noexcept;
+
+  // O(log n) amortized, strong
+  void push_back(T const&);
+  // O(log n)
+  void pop_back() noexcept;
+
+  // O(log n)
+  iterator begin() noexcept;
+  // O(log n)
+  const_iterator begin() const noexcept;
+
+  // O(1)
+  iterator end() noexcept;
+  // O(1)
+  const_iterator end() const noexcept;
+
+  // O(1)
+  reverse_iterator rbegin() noexcept;
+  // O(1)
+  const_reverse_iterator rbegin() const noexcept;
+
+  // O(log n)
+  reverse_iterator rend() noexcept;
+  // O(log n)
+  const_reverse_iterator rend() const noexcept;
+
+  // O(n)
+  void clear() noexcept;
+
+  // O(log n)
+  T& at(std::size_t i) noexcept;
+  // O(log n)
+  T const& at(std::size_t i) const noexcept;
+  // O(log n)
+  // i == size() gives end()
+  iterator nth(std::size_t i) noexcept;
+  // O(log n)
+  const_iterator nth(std::size_t i) const noexcept;
+  // O(log n)
+  std::size_t index_of(const_iterator pos) const noexcept;
+  // O(1)
+  // whether a comes strictly before b
+  bool precedes(const_iterator a, const_iterator b) const noexcept;
+
+  // O(log n) amortized, strong
+  iterator insert(const_iterator pos, T const& val);
+  // O(log n) amortized, strong
+  iterator insert_at(std::size_t i, T const& val);
+  // O(log n)
+  iterator erase(const_iterator pos) noexcept;
+  // O(log n)
+  iterator erase_at(std::size_t i) noexcept;
+
+  friend void swap(indexed_list& a, indexed_list& b) noexcept {
+    a.swap(b);
+  }
+
+private:
+  void swap(indexed_list& other) noexcept;
+
+  static void assign_label(node* cur) noexcept;
+
+  template <typename VALUE_TYPE>
+  struct list_iterator {
+  private:
+    node* ptr_{nullptr};
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = VALUE_TYPE;
+    using pointer = VALUE_TYPE*;
+    using reference = VALUE_TYPE&;
+
+    list_iterator() = default;
+
+    list_iterator(iterator const& other) : ptr_(other.ptr_) {}
+
+    reference operator*() const {
+      return ptr_->value();
+    }
+    pointer operator->() const {
+      return &ptr_->value();
+    }
+
+    list_iterator& operator++() & {
+      ptr_ = tree::successor(ptr_);
+      return *this;
+    }
+
+    list_iterator operator++(int) & {
+      list_iterator old = *this;
+      ++(*this);
+      return old;
+    }
+
+    list_iterator& operator--() & {
+      ptr_ = tree::predecessor(ptr_);
+      return *this;
+    }
+
+    list_iterator operator--(int) & {
+      list_iterator old = *this;
+      --(*this);
+      return old;
+    }
+
+    bool operator==(const_iterator const& other) const {
+      return ptr_ == other.ptr_;
+    }
+
+    bool operator!=(const_iterator const& other) const {
+      return ptr_ != other.ptr_;
+    }
+
+  private:
+    explicit list_iterator(node* ptr) : ptr_(ptr) {}
+
+    friend indexed_list;
+  };
+};
+
+template <typename T>
+struct indexed_list<T>::node : treap_node<node> {
+  node() = default;
+
+  T& value();
+
+  void recompute(node const*, node const*) noexcept {}
+  static void destroy(node* cur) noexcept;
+
+private:
+  // increases along the sequence, end_ has the largest one
+  std::uint64_t label_{label_space};
+
+  static constexpr unsigned label_bits = 62;
+  static constexpr std::uint64_t label_space = std::uint64_t(1) << label_bits;
+
+  friend indexed_list;
+};
+
+template <typename T>
+struct indexed_list<T>::data_node : node {
+  explicit data_node(T const& value);
+
+private:
+  T value_;
+
+  friend node;
+};
+
+template <typename T>
+indexed_list<T>::indexed_list() noexcept : tree_() {}
+
+template <typename T>
+indexed_list<T>::indexed_list(indexed_list const& other) : indexed_list() {
+  for (T const& val : other) {
+    push_back(val);
+  }
+}
+
+template <typename T>
+indexed_list<T>& indexed_list<T>::operator=(indexed_list const& other) {
+  if (this != &other) {
+    indexed_list(other).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T>
+indexed_list<T>::indexed_list(indexed_list&& other) noexcept
+    : indexed_list() {
+  swap(other);
+}
+
+template <typename T>
+indexed_list<T>& indexed_list<T>::operator=(indexed_list&& other) noexcept {
+  if (this != &other) {
+    indexed_list(std::move(other)).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T>
+indexed_list<T>::~indexed_list() = default;
+
+template <typename T>
+bool indexed_list<T>::empty() const noexcept {
+  return tree_.empty();
+}
+
+template <typename T>
+std::size_t indexed_list<T>::size() const noexcept {
+  return tree_.size();
+}
+
+template <typename T>
+T& indexed_list<T>::front() noexcept {
+  return *begin();
+}
+
+template <typename T>
+T const& indexed_list<T>::front() const noexcept {
+  return *begin();
+}
+
+template <typename T>
+void indexed_list<T>::push_front(T const& val) {
+  insert(begin(), val);
+}
+
+template <typename T>
+void indexed_list<T>::pop_front() noexcept {
+  erase(begin());
+}
+
+template <typename T>
+T& indexed_list<T>::back() noexcept {
+  return *std::prev(end());
+}
+
+template <typename T>
+T const& indexed_list<T>::back() const noexcept {
+  return *std::prev(end());
+}
+
+template <typename T>
+void indexed_list<T>::push_back(T const& val) {
+  insert(end(), val);
+}
+
+template <typename T>
+void indexed_list<T>::pop_back() noexcept {
+  erase(std::prev(end()));
+}
+
+template <typename T>
+typename indexed_list<T>::iterator indexed_list<T>::begin() noexcept {
+  return iterator(tree_.first());
+}
+
+template <typename T>
+typename indexed_list<T>::const_iterator
+indexed_list<T>::begin() const noexcept {
+  return const_iterator(tree_.first());
+}
+
+template <typename T>
+typename indexed_list<T>::iterator indexed_list<T>::end() noexcept {
+  return iterator(tree_.header());
+}
+
+template <typename T>
+typename indexed_list<T>::const_iterator
+indexed_list<T>::end() const noexcept {
+  return const_iterator(tree_.header());
+}
+
+template <typename T>
+typename indexed_list<T>::reverse_iterator indexed_list<T>::rbegin() noexcept {
+  return reverse_iterator(end());
+}
+
+template <typename T>
+typename indexed_list<T>::const_reverse_iterator
+indexed_list<T>::rbegin() const noexcept {
+  return const_reverse_iterator(end());
+}
+
+template <typename T>
+typename indexed_list<T>::reverse_iterator indexed_list<T>::rend() noexcept {
+  return reverse_iterator(begin());
+}
+
+template <typename T>
+typename indexed_list<T>::const_reverse_iterator
+indexed_list<T>::rend() const noexcept {
+  return const_reverse_iterator(begin());
+}
+
+template <typename T>
+void indexed_list<T>::clear() noexcept {
+  tree_.clear();
+}
+
+template <typename T>
+T& indexed_list<T>::at(std::size_t i) noexcept {
+  assert(i < size());
+  return tree_.nth(i)->value();
+}
+
+template <typename T>
+T const& indexed_list<T>::at(std::size_t i) const noexcept {
+  assert(i < size());
+  return tree_.nth(i)->value();
+}
+
+template <typename T>
+typename indexed_list<T>::iterator
+indexed_list<T>::nth(std::size_t i) noexcept {
+  return iterator(tree_.nth(i));
+}
+
+template <typename T>
+typename indexed_list<T>::const_iterator
+indexed_list<T>::nth(std::size_t i) const noexcept {
+  return const_iterator(tree_.nth(i));
+}
+
+template <typename T>
+std::size_t indexed_list<T>::index_of(const_iterator pos) const noexcept {
+  return tree_.index_of(pos.ptr_);
+}
+
+template <typename T>
+bool indexed_list<T>::precedes(const_iterator a,
+                               const_iterator b) const noexcept {
+  return a.ptr_->label_ < b.ptr_->label_;
+}
+
+template <typename T>
+typename indexed_list<T>::iterator
+indexed_list<T>::insert(const_iterator pos, T const& val) {
+  node* new_node = new data_node(val);
+  tree_.insert_before(pos.ptr_, new_node);
+  assign_label(new_node);
+  return iterator(new_node);
+}
+
+template <typename T>
+typename indexed_list<T>::iterator
+indexed_list<T>::insert_at(std::size_t i, T const& val) {
+  assert(i <= size());
+  return insert(const_iterator(tree_.nth(i)), val);
+}
+
+template <typename T>
+typename indexed_list<T>::iterator
+indexed_list<T>::erase(const_iterator pos) noexcept {
+  node* cur = pos.ptr_;
+  node* next = tree::successor(cur);
+  tree_.erase(cur);
+  node::destroy(cur);
+  return iterator(next);
+}
+
+template <typename T>
+typename indexed_list<T>::iterator
+indexed_list<T>::erase_at(std::size_t i) noexcept {
+  assert(i < size());
+  return erase(const_iterator(tree_.nth(i)));
+}
+
+template <typename T>
+void indexed_list<T>::swap(indexed_list& other) noexcept {
+  tree_.swap(other.tree_);
+}
+
+// labels cur, which is already linked, between its neighbours; when
+// there is no free label the smallest aligned label range around it
+// that is sparse enough is relabeled evenly (Bender et al.), which is
+// amortized O(log n) relabels per insertion
+template <typename T>
+void indexed_list<T>::assign_label(node* cur) noexcept {
+  node* prev = tree::predecessor(cur);
+  node* next = tree::successor(cur);
+  std::uint64_t lo = prev ? prev->label_ : 0;
+  std::uint64_t hi = next->label_;
+  if (hi - lo > 1) {
+    cur->label_ = lo + (hi - lo) / 2;
+    return;
+  }
+
+  node* first = cur;
+  node* last = cur;
+  std::size_t count = 1;
+  double threshold = 1;
+  for (unsigned bits = 1; bits <= node::label_bits; ++bits) {
+    // a range of 2^bits labels may hold at most 1.6^bits nodes
+    threshold *= 1.6;
+    std::uint64_t width = std::uint64_t(1) << bits;
+    std::uint64_t base = lo & ~(width - 1);
+    for (node* p = tree::predecessor(first); p && p->label_ >= base;
+         p = tree::predecessor(first)) {
+      first = p;
+      ++count;
+    }
+    for (node* n = tree::successor(last); n->label_ < base + width;
+         n = tree::successor(last)) {
+      last = n;
+      ++count;
+    }
+    if (count + 1 <= threshold || bits == node::label_bits) {
+      std::uint64_t gap = width / (count + 1);
+      assert(gap > 1);
+      std::uint64_t label = base;
+      for (node* p = first;; p = tree::successor(p)) {
+        label += gap;
+        p->label_ = label;
+        if (p == last) {
+          break;
+        }
+      }
+      return;
+    }
+  }
+}
+
+template <typename T>
+T& indexed_list<T>::node::value() {
+  return static_cast<data_node*>(this)->value_;
+}
+
+template <typename T>
+void indexed_list<T>::node::destroy(node* cur) noexcept {
+  delete static_cast<data_node*>(cur);
+}
+
+template <typename T>
+indexed_list<T>::data_node::data_node(T const& value) : value_(value) {}
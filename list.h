@@ -1,6 +1,20 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
 #include <iterator>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "node-cache.h"
 
 template <typename T>
 class list {
@@ -12,6 +26,8 @@ private:
   struct data_node;
 
   node end_;
+  // incremented by every operation that changes the order of nodes
+  std::size_t version_{0};
 
 public:
   // bidirectional iterator
@@ -22,6 +38,11 @@ public:
   using reverse_iterator = std::reverse_iterator<iterator>;
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+  // positional snapshot, see build_index()
+  class index;
+  // cached position for local positional walks, see make_finger()
+  class finger;
+
   // O(1)
   list() noexcept;
 
@@ -31,6 +52,17 @@ public:
   // O(n), strong
   list& operator=(list const&);
 
+  // O(1)
+  list(list&&) noexcept;
+
+  // O(n) serial pre-pass to find the ranges, then O(n / threads) on
+  // each thread and O(threads) to stitch the sub-chains, strong
+  // copies other using several threads, each building its own sub-chain
+  static list parallel_copy(list const& other, std::size_t threads);
+
+  // O(n)
+  list& operator=(list&&) noexcept;
+
   // O(n)
   ~list();
 
@@ -79,6 +111,37 @@ public:
 
   // O(n)
   void clear() noexcept;
+  // O(n) serial pre-pass to find the ranges, then O(n / threads) on
+  // each thread
+  // destroys the elements using several threads
+  void clear_parallel(std::size_t threads) noexcept;
+
+  // O(n)
+  // snapshot with O(1) positional queries, invalidated by any operation
+  // that inserts, erases or reorders elements
+  index build_index();
+  // O(1)
+  // finger starting at begin(), it falls back to begin() once the list
+  // has been modified
+  finger make_finger() noexcept;
+
+  // O(n)
+  // gathers pointers to up to chunk consecutive elements and calls
+  // f(T* const* elements, std::size_t count) for each batch, a chunk of
+  // 0 is taken as 1
+  template <typename F>
+  void for_each_chunk(F f, std::size_t chunk = 64);
+  // O(n)
+  template <typename F>
+  void for_each_chunk(F f, std::size_t chunk = 64) const;
+  // O(total size)
+  // calls f on every element of the lists in [first, last), which holds
+  // lists or pointers to them, advancing up to group lists round-robin
+  // and prefetching their next nodes; each list is visited in order,
+  // different lists interleave, a group of 0 is taken as 1
+  template <typename InputIt, typename F>
+  static void for_each_interleaved(InputIt first, InputIt last, F f,
+                                   std::size_t group = 8);
 
   // O(1), strong
   iterator insert(const_iterator pos, T const& val);
@@ -90,10 +153,115 @@ public:
   void splice(const_iterator pos, list& other, const_iterator first,
               const_iterator last) noexcept;
 
+  // O(1)
+  // makes new_begin the first element, iterators stay valid
+  void rotate(const_iterator new_begin) noexcept;
+  // O(1)
+  // moves [pos, end()) into the returned list
+  list split(const_iterator pos) noexcept;
+  // O(n)
+  // swaps the links of every node, iterators stay valid
+  void reverse() noexcept;
+
+  // O(n), basic
+  // moves elements not satisfying pred to the end, keeps relative order,
+  // returns iterator to the first of them
+  template <typename Predicate>
+  iterator stable_partition(Predicate pred);
+  // O(n), basic
+  // same as stable_partition, relinking keeps the order for free
+  template <typename Predicate>
+  iterator partition(Predicate pred);
+  // O(n), basic
+  // moves elements not satisfying pred into the returned list,
+  // keeps relative order in both lists
+  template <typename Predicate>
+  list split_partition(Predicate pred);
+
+  // O(n log k), strong
+  // moves the k smallest elements to the front in sorted order,
+  // the rest keep their relative order behind them
+  template <typename Compare = std::less<>>
+  void select_top_k(std::size_t k, Compare comp = Compare());
+  // O(n log n), strong
+  // moves the n + 1 smallest elements to the front in sorted order,
+  // returns iterator to the n-th of them or end()
+  template <typename Compare = std::less<>>
+  iterator nth(std::size_t n, Compare comp = Compare());
+
+  // O(n + m), basic
+  // a and b are sorted, their nodes are moved to the end of res or
+  // destroyed, a and b are left empty
+  template <typename Compare = std::less<>>
+  static void set_union_into(list& a, list& b, list& res,
+                             Compare comp = Compare());
+  // O(n + m), basic
+  template <typename Compare = std::less<>>
+  static void set_intersection_into(list& a, list& b, list& res,
+                                    Compare comp = Compare());
+  // O(n + m), basic
+  // elements of a that are not in b
+  template <typename Compare = std::less<>>
+  static void set_difference_into(list& a, list& b, list& res,
+                                  Compare comp = Compare());
+
+  // O((n + k) log k), basic, stable
+  // [first, last) is a range of k lists sorted by comp, taken like in
+  // for_each_interleaved, merges them together with this sorted list,
+  // the others are left empty, a list that appears more than once or is
+  // this list itself takes part once
+  template <typename InputIt, typename Compare = std::less<>>
+  void merge_k(InputIt first, InputIt last, Compare comp = Compare());
+
+  // O(n) expected, basic
+  // removes every element equal to an earlier one, not only adjacent,
+  // returns the number of removed elements
+  template <typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<>>
+  std::size_t unique_unsorted(Hash hash = Hash(), KeyEqual eq = KeyEqual());
+
+  // O(n), strong
+  // shuffles an array of node pointers and relinks the list
+  template <typename URBG>
+  void shuffle(URBG&& g);
+
+  // O(n log n), basic, stable
+  template <typename Compare = std::less<>>
+  void sort(Compare comp = Compare());
+  // O(n log n), strong, not stable
+  // sorts an array of node pointers, falls back to sort() if the array
+  // can't be allocated
+  template <typename Compare = std::less<>>
+  void sort_via_index(Compare comp = Compare());
+  // O(n * sizeof(key)), basic, stable
+  // key_fn projects an element to an integral key, false sorts before true
+  template <typename KeyFn>
+  void radix_sort(KeyFn key_fn);
+
   friend void swap(list& a, list& b) noexcept {
     a.swap(b);
   }
 
+  // O(n) serial pre-pass to find the ranges, then O(n / threads) on
+  // each thread
+  // calls f on every element, splitting the list into ranges that are
+  // processed concurrently; rethrows the first exception thrown by f
+  template <typename F>
+  friend void parallel_for_each(list& l, F f, std::size_t threads) {
+    l.parallel_for_each(f, threads);
+  }
+
+  // O(n) serial pre-pass to find the ranges, then O(n / threads) on
+  // each thread and O(threads) to combine the ranges
+  // init combined with transform(x) for every x, reduce is applied in
+  // list order within and across ranges and must be associative
+  template <typename R, typename Reduce, typename Transform>
+  friend R parallel_transform_reduce(list const& l, R init, Reduce reduce,
+                                     Transform transform,
+                                     std::size_t threads) {
+    return l.parallel_transform_reduce(std::move(init), reduce, transform,
+                                       threads);
+  }
+
 private:
   node* copy_node(node* right, node* orig, node const* end);
 
@@ -101,6 +269,38 @@ private:
 
   static void destruct_list(node* cur);
 
+  std::vector<node*> split_points(std::size_t parts) const;
+  template <typename Worker>
+  static void run_parallel(std::size_t parts, Worker& worker);
+
+  template <typename F>
+  void parallel_for_each(F& f, std::size_t threads);
+  template <typename R, typename Reduce, typename Transform>
+  R parallel_transform_reduce(R init, Reduce& reduce, Transform& transform,
+                              std::size_t threads) const;
+
+  static void unlink(node* cur) noexcept;
+  static void link_before(node* pos, node* cur) noexcept;
+  static void transfer(node* pos, node* cur) noexcept;
+  static void prefetch(node const* cur) noexcept;
+  // ranges of lists may hold lists or pointers to them
+  static list& as_list(list& other) noexcept;
+  static list& as_list(list* other) noexcept;
+  std::vector<node*> collect_nodes();
+  void relink(std::vector<node*> const& nodes) noexcept;
+  void link_buckets(node* const* heads, node* const* tails,
+                    node* rest) noexcept;
+  void restore_left_links() noexcept;
+
+  template <typename Predicate>
+  void move_unsatisfying(Predicate& pred, list& rest);
+
+  template <typename Compare>
+  static node* merge_sort(node* first, std::size_t n, Compare& comp);
+  template <typename Compare>
+  static node* merge(node* first, node* mid, node const* last,
+                     Compare& comp);
+
   template <typename VALUE_TYPE>
   struct list_iterator {
   private:
@@ -161,6 +361,58 @@ private:
   };
 };
 
+template <typename T>
+class list<T>::index {
+public:
+  // O(1)
+  // false once the list has been modified after build_index()
+  bool valid() const noexcept;
+
+  // O(1)
+  std::size_t size() const noexcept;
+
+  // O(1)
+  // i == size() gives end()
+  iterator nth(std::size_t i) const noexcept;
+
+  // O(1) expected
+  std::size_t position(const_iterator it) const;
+
+  // O(1) expected
+  std::ptrdiff_t distance(const_iterator first, const_iterator last) const;
+
+private:
+  explicit index(list& owner);
+
+  list const* owner_;
+  std::size_t version_;
+  // nodes_[size()] is end_
+  std::vector<node*> nodes_;
+  std::unordered_map<node const*, std::size_t> positions_;
+
+  friend list;
+};
+
+template <typename T>
+class list<T>::finger {
+public:
+  // O(min(i, |i - last i|, size() - i))
+  // walks from begin(), the previous position or end(), whichever is
+  // closer, the distance to end() is known once a walk has reached it
+  iterator nth(std::size_t i) noexcept;
+
+private:
+  explicit finger(list& owner) noexcept;
+
+  list* owner_;
+  std::size_t version_;
+  node* pos_;
+  std::size_t index_{0};
+  std::optional<std::size_t> size_;
+
+  friend list;
+};
+
 template <typename T>
 struct list<T>::node {
   node() = default;
@@ -178,6 +430,10 @@ template <typename T>
 struct list<T>::data_node : node {
   data_node(T const& value, node* left, node* right);
 
+  // go through node_cache if enable_node_cache<T> is specialized
+  static void* operator new(std::size_t size);
+  static void operator delete(void* ptr) noexcept;
+
 private:
   T value_;
 
@@ -203,6 +459,57 @@ list<T>& list<T>::operator=(list const& other) {
   return *this;
 }
 
+template <typename T>
+list<T>::list(list&& other) noexcept : list() {
+  swap(other);
+}
+
+template <typename T>
+list<T>& list<T>::operator=(list&& other) noexcept {
+  if (this != &other) {
+    list(std::move(other)).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T>
+list<T> list<T>::parallel_copy(list const& other, std::size_t threads) {
+  std::vector<node*> bounds = other.split_points(threads);
+  // first and last node of every copied range
+  std::vector<std::pair<node*, node*>> chains(bounds.size() - 1);
+  auto worker = [&bounds, &chains](std::size_t i) {
+    auto& [first, last] = chains[i];
+    for (node* cur = bounds[i]; cur != bounds[i + 1]; cur = cur->right_) {
+      node* copy = new data_node(cur->value(), last, nullptr);
+      if (last) {
+        last->right_ = copy;
+      } else {
+        first = copy;
+      }
+      last = copy;
+    }
+  };
+  try {
+    run_parallel(chains.size(), worker);
+  } catch (...) {
+    for (auto& chain : chains) {
+      destruct_list(chain.second);
+    }
+    throw;
+  }
+
+  list res;
+  node* prev = &res.end_;
+  for (auto& [first, last] : chains) {
+    prev->right_ = first;
+    first->left_ = prev;
+    prev = last;
+  }
+  prev->right_ = &res.end_;
+  res.end_.left_ = prev;
+  return res;
+}
+
 template <typename T>
 list<T>::~list() {
   end_.right_->left_ = nullptr;
@@ -296,16 +603,128 @@ typename list<T>::const_reverse_iterator list<T>::rend() const noexcept {
 
 template <typename T>
 void list<T>::clear() noexcept {
+  ++version_;
   end_.right_->left_ = nullptr;
   destruct_list(end_.left_);
   end_.left_ = &end_;
   end_.right_ = &end_;
 }
 
+template <typename T>
+typename list<T>::index list<T>::build_index() {
+  return index(*this);
+}
+
+template <typename T>
+typename list<T>::finger list<T>::make_finger() noexcept {
+  return finger(*this);
+}
+
+template <typename T>
+template <typename F>
+void list<T>::for_each_chunk(F f, std::size_t chunk) {
+  chunk = std::max(chunk, std::size_t(1));
+  // grows while gathering, so a huge chunk costs no more than the list
+  std::vector<T*> buffer;
+  node* cur = end_.right_;
+  while (cur != &end_) {
+    buffer.clear();
+    for (; buffer.size() < chunk && cur != &end_; cur = cur->right_) {
+      buffer.push_back(&cur->value());
+    }
+    f(buffer.data(), buffer.size());
+  }
+}
+
+template <typename T>
+template <typename F>
+void list<T>::for_each_chunk(F f, std::size_t chunk) const {
+  const_cast<list*>(this)->for_each_chunk(
+      [&f](T* const* elements, std::size_t count) {
+        T const* const* const_elements = elements;
+        f(const_elements, count);
+      },
+      chunk);
+}
+
+template <typename T>
+template <typename InputIt, typename F>
+void list<T>::for_each_interleaved(InputIt first, InputIt last, F f,
+                                   std::size_t group) {
+  group = std::max(group, std::size_t(1));
+  struct cursor {
+    node* cur;
+    node const* end;
+  };
+  std::vector<cursor> active;
+  active.reserve(group);
+  auto refill = [&] {
+    for (; active.size() < group && first != last; ++first) {
+      list& other = as_list(*first);
+      if (!other.empty()) {
+        prefetch(other.end_.right_);
+        active.push_back({other.end_.right_, &other.end_});
+      }
+    }
+  };
+
+  refill();
+  while (!active.empty()) {
+    for (std::size_t i = 0; i < active.size();) {
+      cursor& c = active[i];
+      node* cur = c.cur;
+      c.cur = cur->right_;
+      prefetch(c.cur);
+      f(cur->value());
+      if (c.cur == c.end) {
+        active[i] = active.back();
+        active.pop_back();
+        refill();
+      } else {
+        ++i;
+      }
+    }
+  }
+}
+
+template <typename T>
+void list<T>::clear_parallel(std::size_t threads) noexcept {
+  std::vector<node*> bounds;
+  try {
+    bounds = split_points(threads);
+  } catch (...) {
+    clear();
+    return;
+  }
+  // cut the chain into ranges, keep the last node of every range
+  std::size_t parts = bounds.size() - 1;
+  for (std::size_t i = 0; i < parts; ++i) {
+    node* last = bounds[i + 1]->left_;
+    bounds[i]->left_ = nullptr;
+    bounds[i] = last;
+  }
+  end_.left_ = &end_;
+  end_.right_ = &end_;
+  ++version_;
+
+  auto worker = [&bounds](std::size_t i) noexcept {
+    destruct_list(bounds[i]);
+  };
+  try {
+    run_parallel(parts, worker);
+  } catch (...) {
+    // nothing has been destroyed yet, workers don't throw
+    for (std::size_t i = 0; i < parts; ++i) {
+      destruct_list(bounds[i]);
+    }
+  }
+}
+
 template <typename T>
 typename list<T>::iterator list<T>::insert(const_iterator pos, T const& val) {
   node* cur = pos.ptr_;
   node* new_node = new data_node(val, cur->left_, cur);
+  ++version_;
   cur->left_->right_ = new_node;
   cur->left_ = new_node;
   return iterator(new_node);
@@ -320,6 +739,7 @@ template <typename T>
 typename list<T>::iterator list<T>::erase(const_iterator first,
                                           const_iterator last) noexcept {
   if (first != last) {
+    ++version_;
     node* cur1 = first.ptr_;
     node* cur2 = last.ptr_->left_;
 
@@ -339,6 +759,8 @@ void list<T>::splice(const_iterator pos, list<T>& other, const_iterator first,
   if (first == last) {
     return;
   }
+  ++version_;
+  ++other.version_;
   node* cur1 = first.ptr_;
   node* cur2 = last.ptr_->left_;
   node* cur_pos = pos.ptr_;
@@ -353,6 +775,404 @@ void list<T>::splice(const_iterator pos, list<T>& other, const_iterator first,
   cur_pos->left_ = cur2;
 }
 
+template <typename T>
+void list<T>::rotate(const_iterator new_begin) noexcept {
+  node* pos = new_begin.ptr_;
+  if (pos == &end_ || pos == end_.right_) {
+    return;
+  }
+  ++version_;
+  unlink(&end_);
+  link_before(pos, &end_);
+}
+
+template <typename T>
+list<T> list<T>::split(const_iterator pos) noexcept {
+  list res;
+  res.splice(res.end(), *this, pos, end());
+  return res;
+}
+
+template <typename T>
+void list<T>::reverse() noexcept {
+  ++version_;
+  node* cur = &end_;
+  do {
+    std::swap(cur->left_, cur->right_);
+    cur = cur->left_;
+  } while (cur != &end_);
+}
+
+template <typename T>
+template <typename Predicate>
+typename list<T>::iterator list<T>::stable_partition(Predicate pred) {
+  list rest = split_partition(pred);
+  iterator res(rest.end_.right_ == &rest.end_ ? &end_ : rest.end_.right_);
+  splice(end(), rest, rest.begin(), rest.end());
+  return res;
+}
+
+template <typename T>
+template <typename Predicate>
+typename list<T>::iterator list<T>::partition(Predicate pred) {
+  return stable_partition(pred);
+}
+
+template <typename T>
+template <typename Predicate>
+list<T> list<T>::split_partition(Predicate pred) {
+  ++version_;
+  list rest;
+  try {
+    move_unsatisfying(pred, rest);
+  } catch (...) {
+    splice(end(), rest, rest.begin(), rest.end());
+    throw;
+  }
+  return rest;
+}
+
+template <typename T>
+template <typename Compare>
+void list<T>::select_top_k(std::size_t k, Compare comp) {
+  if (k == 0) {
+    return;
+  }
+  auto less = [&comp](node* a, node* b) {
+    return comp(a->value(), b->value());
+  };
+  // max-heap of the k smallest elements seen so far
+  std::vector<node*> heap;
+  for (node* cur = end_.right_; cur != &end_; cur = cur->right_) {
+    if (heap.size() < k) {
+      heap.push_back(cur);
+      std::push_heap(heap.begin(), heap.end(), less);
+    } else if (less(cur, heap.front())) {
+      std::pop_heap(heap.begin(), heap.end(), less);
+      heap.back() = cur;
+      std::push_heap(heap.begin(), heap.end(), less);
+    }
+  }
+  std::sort_heap(heap.begin(), heap.end(), less);
+
+  ++version_;
+  node* pos = end_.right_;
+  for (node* cur : heap) {
+    if (cur == pos) {
+      pos = pos->right_;
+    } else {
+      transfer(pos, cur);
+    }
+  }
+}
+
+template <typename T>
+template <typename Compare>
+typename list<T>::iterator list<T>::nth(std::size_t n, Compare comp) {
+  select_top_k(n + 1, comp);
+  node* cur = end_.right_;
+  for (std::size_t i = 0; i < n && cur != &end_; ++i) {
+    cur = cur->right_;
+  }
+  return iterator(cur);
+}
+
+template <typename T>
+template <typename Compare>
+void list<T>::set_union_into(list& a, list& b, list& res, Compare comp) {
+  assert(&a != &res && &b != &res && &a != &b);
+  ++a.version_;
+  ++b.version_;
+  ++res.version_;
+  list rejected;
+  while (!a.empty() && !b.empty()) {
+    node* x = a.end_.right_;
+    node* y = b.end_.right_;
+    if (comp(y->value(), x->value())) {
+      transfer(&res.end_, y);
+    } else {
+      if (!comp(x->value(), y->value())) {
+        transfer(&rejected.end_, y);
+      }
+      transfer(&res.end_, x);
+    }
+  }
+  res.splice(res.end(), a, a.begin(), a.end());
+  res.splice(res.end(), b, b.begin(), b.end());
+}
+
+template <typename T>
+template <typename Compare>
+void list<T>::set_intersection_into(list& a, list& b, list& res,
+                                    Compare comp) {
+  assert(&a != &res && &b != &res && &a != &b);
+  ++a.version_;
+  ++b.version_;
+  ++res.version_;
+  list rejected;
+  while (!a.empty() && !b.empty()) {
+    node* x = a.end_.right_;
+    node* y = b.end_.right_;
+    if (comp(x->value(), y->value())) {
+      transfer(&rejected.end_, x);
+    } else if (comp(y->value(), x->value())) {
+      transfer(&rejected.end_, y);
+    } else {
+      transfer(&res.end_, x);
+      transfer(&rejected.end_, y);
+    }
+  }
+  rejected.splice(rejected.end(), a, a.begin(), a.end());
+  rejected.splice(rejected.end(), b, b.begin(), b.end());
+}
+
+template <typename T>
+template <typename Compare>
+void list<T>::set_difference_into(list& a, list& b, list& res,
+                                  Compare comp) {
+  assert(&a != &res && &b != &res && &a != &b);
+  ++a.version_;
+  ++b.version_;
+  ++res.version_;
+  list rejected;
+  while (!a.empty() && !b.empty()) {
+    node* x = a.end_.right_;
+    node* y = b.end_.right_;
+    if (comp(x->value(), y->value())) {
+      transfer(&res.end_, x);
+    } else if (comp(y->value(), x->value())) {
+      transfer(&rejected.end_, y);
+    } else {
+      transfer(&rejected.end_, x);
+      transfer(&rejected.end_, y);
+    }
+  }
+  res.splice(res.end(), a, a.begin(), a.end());
+  rejected.splice(rejected.end(), b, b.begin(), b.end());
+}
+
+template <typename T>
+template <typename InputIt, typename Compare>
+void list<T>::merge_k(InputIt first, InputIt last, Compare comp) {
+  struct cursor {
+    node* cur;
+    node const* end;
+    std::size_t source;
+  };
+  // min-heap by value, ties go to the earlier source
+  auto greater = [&comp](cursor const& a, cursor const& b) {
+    return comp(b.cur->value(), a.cur->value()) ||
+           (!comp(a.cur->value(), b.cur->value()) && a.source > b.source);
+  };
+
+  // a list that appears again keeps only its first position
+  std::vector<std::pair<list*, std::size_t>> sources{{this, 0}};
+  for (std::size_t source = 1; first != last; ++first, ++source) {
+    list& other = as_list(*first);
+    sources.emplace_back(&other, source);
+  }
+  std::sort(sources.begin(), sources.end(), [](auto const& a, auto const& b) {
+    return a.first != b.first ? std::less<list*>()(a.first, b.first)
+                              : a.second < b.second;
+  });
+  sources.erase(std::unique(sources.begin(), sources.end(),
+                            [](auto const& a, auto const& b) {
+                              return a.first == b.first;
+                            }),
+                sources.end());
+
+  std::vector<cursor> heap;
+  heap.reserve(sources.size());
+  for (auto [other, source] : sources) {
+    if (!other->empty()) {
+      if (other != this) {
+        ++other->version_;
+      }
+      heap.push_back({other->end_.right_, &other->end_, source});
+      prefetch(other->end_.right_);
+    }
+  }
+
+  list res;
+  try {
+    std::make_heap(heap.begin(), heap.end(), greater);
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), greater);
+      cursor& top = heap.back();
+      node* cur = top.cur;
+      top.cur = cur->right_;
+      transfer(&res.end_, cur);
+      if (top.cur != top.end) {
+        prefetch(top.cur->right_);
+        std::push_heap(heap.begin(), heap.end(), greater);
+      } else {
+        heap.pop_back();
+      }
+    }
+  } catch (...) {
+    splice(begin(), res, res.begin(), res.end());
+    throw;
+  }
+  swap(res);
+}
+
+template <typename T>
+template <typename Hash, typename KeyEqual>
+std::size_t list<T>::unique_unsorted(Hash hash, KeyEqual eq) {
+  std::size_t n = std::distance(begin(), end());
+  unsigned bits = 1;
+  while ((std::size_t(1) << bits) < 2 * n) {
+    ++bits;
+  }
+  std::size_t const mask = (std::size_t(1) << bits) - 1;
+  // open addressing with linear probing, fibonacci hashing spreads
+  // weak hashes like the identity over the table
+  std::vector<node*> table(mask + 1, nullptr);
+
+  ++version_;
+  list removed;
+  std::size_t count = 0;
+  node* cur = end_.right_;
+  while (cur != &end_) {
+    node* next = cur->right_;
+    std::uint64_t h = hash(cur->value());
+    std::size_t i = (h * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - bits);
+    while (table[i] && !eq(table[i]->value(), cur->value())) {
+      i = (i + 1) & mask;
+    }
+    if (table[i]) {
+      transfer(&removed.end_, cur);
+      ++count;
+    } else {
+      table[i] = cur;
+    }
+    cur = next;
+  }
+  return count;
+}
+
+template <typename T>
+template <typename URBG>
+void list<T>::shuffle(URBG&& g) {
+  std::vector<node*> nodes = collect_nodes();
+  std::shuffle(nodes.begin(), nodes.end(), g);
+  relink(nodes);
+}
+
+template <typename T>
+template <typename Compare>
+void list<T>::sort(Compare comp) {
+  ++version_;
+  merge_sort(end_.right_, std::distance(begin(), end()), comp);
+}
+
+template <typename T>
+template <typename Compare>
+void list<T>::sort_via_index(Compare comp) {
+  std::vector<node*> nodes;
+  try {
+    nodes = collect_nodes();
+  } catch (std::bad_alloc const&) {
+    sort(comp);
+    return;
+  }
+  std::sort(nodes.begin(), nodes.end(), [&comp](node* a, node* b) {
+    return comp(a->value(), b->value());
+  });
+  relink(nodes);
+}
+
+template <typename T>
+template <typename KeyFn>
+void list<T>::radix_sort(KeyFn key_fn) {
+  using key_type = std::decay_t<decltype(key_fn(std::declval<T&>()))>;
+  static_assert(std::is_integral_v<key_type>,
+                "radix_sort key must be integral");
+  // make_unsigned doesn't take bool
+  using ukey_type = std::make_unsigned_t<
+      std::conditional_t<std::is_same_v<key_type, bool>, char, key_type>>;
+  constexpr std::size_t bits = sizeof(ukey_type) * 8;
+  // flipping the sign bit orders signed keys as unsigned ones
+  constexpr ukey_type sign =
+      std::is_signed_v<key_type> ? ukey_type(ukey_type(1) << (bits - 1)) : 0;
+
+  if (empty()) {
+    return;
+  }
+  ++version_;
+  node* heads[256];
+  node* tails[256];
+  ukey_type first_key = 0;
+  ukey_type diff = 0;
+  for (std::size_t shift = 0; shift < bits; shift += 8) {
+    // a byte equal in all keys doesn't change the order
+    if (shift != 0 && ((diff >> shift) & 0xff) == 0) {
+      continue;
+    }
+    std::fill(heads, heads + 256, nullptr);
+    node* cur = end_.right_;
+    try {
+      while (cur != &end_) {
+        ukey_type key = static_cast<ukey_type>(key_fn(cur->value())) ^ sign;
+        if (shift == 0) {
+          if (cur == end_.right_) {
+            first_key = key;
+          }
+          diff |= key ^ first_key;
+        }
+        std::size_t bucket = (key >> shift) & 0xff;
+        if (heads[bucket]) {
+          tails[bucket]->right_ = cur;
+        } else {
+          heads[bucket] = cur;
+        }
+        tails[bucket] = cur;
+        cur = cur->right_;
+      }
+    } catch (...) {
+      link_buckets(heads, tails, cur);
+      restore_left_links();
+      throw;
+    }
+    link_buckets(heads, tails, &end_);
+  }
+  restore_left_links();
+}
+
+template <typename T>
+template <typename F>
+void list<T>::parallel_for_each(F& f, std::size_t threads) {
+  std::vector<node*> bounds = split_points(threads);
+  auto worker = [&bounds, &f](std::size_t i) {
+    for (node* cur = bounds[i]; cur != bounds[i + 1]; cur = cur->right_) {
+      f(cur->value());
+    }
+  };
+  run_parallel(bounds.size() - 1, worker);
+}
+
+template <typename T>
+template <typename R, typename Reduce, typename Transform>
+R list<T>::parallel_transform_reduce(R init, Reduce& reduce,
+                                     Transform& transform,
+                                     std::size_t threads) const {
+  std::vector<node*> bounds = split_points(threads);
+  std::vector<std::optional<R>> partial(bounds.size() - 1);
+  auto worker = [&bounds, &partial, &reduce, &transform](std::size_t i) {
+    node* cur = bounds[i];
+    R acc = transform(std::as_const(cur->value()));
+    for (cur = cur->right_; cur != bounds[i + 1]; cur = cur->right_) {
+      acc = reduce(std::move(acc), transform(std::as_const(cur->value())));
+    }
+    partial[i].emplace(std::move(acc));
+  };
+  run_parallel(partial.size(), worker);
+  for (std::optional<R>& acc : partial) {
+    init = reduce(std::move(init), std::move(*acc));
+  }
+  return init;
+}
+
 template <typename T>
 typename list<T>::node* list<T>::copy_node(node* right, node* orig,
                                            node const* end) {
@@ -372,6 +1192,8 @@ typename list<T>::node* list<T>::copy_node(node* right, node* orig,
 
 template <typename T>
 void list<T>::swap(list<T>& other) {
+  ++version_;
+  ++other.version_;
   if (empty()) {
     end_.left_ = &other.end_;
     end_.right_ = &other.end_;
@@ -391,11 +1213,287 @@ void list<T>::swap(list<T>& other) {
 
 template <typename T>
 void list<T>::destruct_list(node* cur) {
-  if (!cur) {
-    return;
+  while (cur) {
+    node* left = cur->left_;
+    delete static_cast<data_node*>(cur);
+    cur = left;
+  }
+}
+
+// splits the list into at most parts non-empty ranges of nearly equal
+// length, returns their boundaries, the last one is end_
+// O(n) on the calling thread: one walk to count, one to place the bounds
+template <typename T>
+std::vector<typename list<T>::node*>
+list<T>::split_points(std::size_t parts) const {
+  std::size_t n = std::distance(begin(), end());
+  parts = std::min(std::max(parts, std::size_t(1)), n);
+  std::vector<node*> bounds;
+  bounds.reserve(parts + 1);
+  node* cur = end_.right_;
+  for (std::size_t i = 0; i < parts; ++i) {
+    bounds.push_back(cur);
+    for (std::size_t j = n / parts + (i < n % parts); j > 0; --j) {
+      cur = cur->right_;
+    }
+  }
+  bounds.push_back(const_cast<node*>(&end_));
+  return bounds;
+}
+
+// calls worker(i) for every i in [0, parts) on separate threads, runs
+// a part on the calling thread if its thread can't be started,
+// rethrows the first exception after all parts are finished
+template <typename T>
+template <typename Worker>
+void list<T>::run_parallel(std::size_t parts, Worker& worker) {
+  std::vector<std::exception_ptr> errors(parts);
+  std::vector<std::thread> threads;
+  threads.reserve(parts);
+  auto run = [&worker, &errors](std::size_t i) {
+    try {
+      worker(i);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  };
+  for (std::size_t i = 1; i < parts; ++i) {
+    try {
+      threads.emplace_back(run, i);
+    } catch (...) {
+      run(i);
+    }
+  }
+  if (parts != 0) {
+    run(0);
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  for (std::exception_ptr& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+template <typename T>
+void list<T>::unlink(node* cur) noexcept {
+  cur->left_->right_ = cur->right_;
+  cur->right_->left_ = cur->left_;
+}
+
+template <typename T>
+void list<T>::link_before(node* pos, node* cur) noexcept {
+  cur->left_ = pos->left_;
+  cur->right_ = pos;
+  pos->left_->right_ = cur;
+  pos->left_ = cur;
+}
+
+template <typename T>
+void list<T>::transfer(node* pos, node* cur) noexcept {
+  unlink(cur);
+  link_before(pos, cur);
+}
+
+template <typename T>
+void list<T>::prefetch(node const* cur) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(cur);
+#else
+  static_cast<void>(cur);
+#endif
+}
+
+template <typename T>
+list<T>& list<T>::as_list(list& other) noexcept {
+  return other;
+}
+
+template <typename T>
+list<T>& list<T>::as_list(list* other) noexcept {
+  return *other;
+}
+
+template <typename T>
+std::vector<typename list<T>::node*> list<T>::collect_nodes() {
+  std::vector<node*> nodes;
+  nodes.reserve(std::distance(begin(), end()));
+  for (node* cur = end_.right_; cur != &end_; cur = cur->right_) {
+    nodes.push_back(cur);
+  }
+  return nodes;
+}
+
+template <typename T>
+void list<T>::relink(std::vector<node*> const& nodes) noexcept {
+  ++version_;
+  node* prev = &end_;
+  for (node* cur : nodes) {
+    prev->right_ = cur;
+    cur->left_ = prev;
+    prev = cur;
+  }
+  prev->right_ = &end_;
+  end_.left_ = prev;
+}
+
+template <typename T>
+template <typename Predicate>
+void list<T>::move_unsatisfying(Predicate& pred, list& rest) {
+  node* cur = end_.right_;
+  while (cur != &end_) {
+    node* next = cur->right_;
+    if (!pred(cur->value())) {
+      transfer(&rest.end_, cur);
+    }
+    cur = next;
+  }
+}
+
+// chains non-empty buckets through right_ and appends rest,
+// left_ pointers are fixed separately by restore_left_links()
+template <typename T>
+void list<T>::link_buckets(node* const* heads, node* const* tails,
+                           node* rest) noexcept {
+  node* prev = &end_;
+  for (std::size_t i = 0; i < 256; ++i) {
+    if (heads[i]) {
+      prev->right_ = heads[i];
+      prev = tails[i];
+    }
+  }
+  prev->right_ = rest;
+}
+
+template <typename T>
+void list<T>::restore_left_links() noexcept {
+  node* cur = &end_;
+  do {
+    cur->right_->left_ = cur;
+    cur = cur->right_;
+  } while (cur != &end_);
+}
+
+// sorts n nodes starting from first, returns the new first node
+template <typename T>
+template <typename Compare>
+typename list<T>::node* list<T>::merge_sort(node* first, std::size_t n,
+                                            Compare& comp) {
+  if (n < 2) {
+    return first;
+  }
+  std::size_t half = n / 2;
+  node* mid = first;
+  for (std::size_t i = 0; i < half; ++i) {
+    mid = mid->right_;
+  }
+  node* last = mid;
+  for (std::size_t i = half; i < n; ++i) {
+    last = last->right_;
+  }
+  first = merge_sort(first, half, comp);
+  mid = merge_sort(mid, n - half, comp);
+  return merge(first, mid, last, comp);
+}
+
+// merges adjacent sorted runs [first, mid) and [mid, last),
+// returns the new first node
+template <typename T>
+template <typename Compare>
+typename list<T>::node* list<T>::merge(node* first, node* mid,
+                                       node const* last, Compare& comp) {
+  node* res = first;
+  while (first != mid && mid != last) {
+    if (comp(mid->value(), first->value())) {
+      node* next = mid->right_;
+      transfer(first, mid);
+      if (res == first) {
+        res = mid;
+      }
+      mid = next;
+    } else {
+      first = first->right_;
+    }
   }
-  destruct_list(cur->left_);
-  delete static_cast<data_node*>(cur);
+  return res;
+}
+
+template <typename T>
+list<T>::index::index(list& owner)
+    : owner_(&owner), version_(owner.version_), nodes_(owner.collect_nodes()) {
+  nodes_.push_back(&owner.end_);
+  positions_.reserve(nodes_.size());
+  for (std::size_t i = 0; i < nodes_.size(); ++i) {
+    positions_.emplace(nodes_[i], i);
+  }
+}
+
+template <typename T>
+bool list<T>::index::valid() const noexcept {
+  return owner_->version_ == version_;
+}
+
+template <typename T>
+std::size_t list<T>::index::size() const noexcept {
+  return nodes_.size() - 1;
+}
+
+template <typename T>
+typename list<T>::iterator
+list<T>::index::nth(std::size_t i) const noexcept {
+  assert(valid() && i < nodes_.size());
+  return iterator(nodes_[i]);
+}
+
+template <typename T>
+std::size_t list<T>::index::position(const_iterator it) const {
+  assert(valid());
+  return positions_.at(it.ptr_);
+}
+
+template <typename T>
+std::ptrdiff_t list<T>::index::distance(const_iterator first,
+                                        const_iterator last) const {
+  return static_cast<std::ptrdiff_t>(position(last)) -
+         static_cast<std::ptrdiff_t>(position(first));
+}
+
+template <typename T>
+list<T>::finger::finger(list& owner) noexcept
+    : owner_(&owner), version_(owner.version_), pos_(owner.end_.right_) {}
+
+template <typename T>
+typename list<T>::iterator list<T>::finger::nth(std::size_t i) noexcept {
+  if (version_ != owner_->version_) {
+    // the remembered node may have been erased
+    version_ = owner_->version_;
+    pos_ = owner_->end_.right_;
+    index_ = 0;
+    size_.reset();
+  }
+  std::size_t steps = i < index_ ? index_ - i : i - index_;
+  if (i < steps) {
+    pos_ = owner_->end_.right_;
+    index_ = 0;
+    steps = i;
+  }
+  if (size_ && *size_ - i < steps) {
+    pos_ = &owner_->end_;
+    index_ = *size_;
+  }
+  for (; index_ < i; ++index_) {
+    assert(pos_ != &owner_->end_);
+    pos_ = pos_->right_;
+  }
+  for (; index_ > i; --index_) {
+    pos_ = pos_->left_;
+  }
+  if (pos_ == &owner_->end_) {
+    size_ = index_;
+  }
+  return iterator(pos_);
 }
 
 template <typename T>
@@ -403,6 +1501,25 @@ T& list<T>::node::value() {
   return static_cast<data_node*>(this)->value_;
 }
 
+template <typename T>
+void* list<T>::data_node::operator new(std::size_t size) {
+  if constexpr (enable_node_cache<T>::value) {
+    static_assert(alignof(data_node) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    return node_cache<sizeof(data_node)>::allocate();
+  } else {
+    return ::operator new(size);
+  }
+}
+
+template <typename T>
+void list<T>::data_node::operator delete(void* ptr) noexcept {
+  if constexpr (enable_node_cache<T>::value) {
+    node_cache<sizeof(data_node)>::deallocate(ptr);
+  } else {
+    ::operator delete(ptr);
+  }
+}
+
 template <typename T>
 list<T>::data_node::data_node(const T& value, node* left, node* right)
     : value_(value) {
@@ -0,0 +1,141 @@
+#pragma once
+#include <atomic>
+#include <optional>
+#include <utility>
+
+// queue for many producer threads and a single consumer thread,
+// nodes are linked with right_ pointers like in list, producers
+// exchange the head and then link the previous head to the new node
+// (Vyukov's intrusive MPSC queue with a stub node)
+template <typename T>
+class mpsc_list {
+private:
+  struct node;
+  struct data_node;
+
+public:
+  // O(1)
+  mpsc_list() noexcept;
+
+  mpsc_list(mpsc_list const&) = delete;
+  mpsc_list& operator=(mpsc_list const&) = delete;
+
+  // O(n)
+  // no producer may be running
+  ~mpsc_list();
+
+  // O(1), strong, lock-free
+  // may be called from any thread
+  void push_back(T const&);
+
+  // O(1), strong, wait-free
+  // consumer thread only, returns nothing if the queue is empty or the
+  // producer of the first element has not finished linking it yet
+  std::optional<T> pop_front();
+
+  // O(1)
+  // consumer thread only
+  bool empty() const noexcept;
+
+private:
+  void link(node* new_node) noexcept;
+
+  // the most recently pushed node, written by producers
+  alignas(64) std::atomic<node*> head_;
+  // the next node to pop, owned by the consumer
+  alignas(64) node* tail_;
+  // keeps the chain non-empty so that producers never touch tail_
+  node stub_;
+};
+
+template <typename T>
+struct mpsc_list<T>::node {
+  node() = default;
+
+  T& value();
+
+private:
+  std::atomic<node*> right_{nullptr};
+
+  friend mpsc_list;
+};
+
+template <typename T>
+struct mpsc_list<T>::data_node : node {
+  explicit data_node(T const& value);
+
+private:
+  T value_;
+
+  friend node;
+};
+
+template <typename T>
+mpsc_list<T>::mpsc_list() noexcept : head_(&stub_), tail_(&stub_), stub_() {}
+
+template <typename T>
+mpsc_list<T>::~mpsc_list() {
+  node* cur = tail_;
+  while (cur) {
+    node* next = cur->right_.load(std::memory_order_relaxed);
+    if (cur != &stub_) {
+      delete static_cast<data_node*>(cur);
+    }
+    cur = next;
+  }
+}
+
+template <typename T>
+void mpsc_list<T>::push_back(T const& val) {
+  link(new data_node(val));
+}
+
+template <typename T>
+std::optional<T> mpsc_list<T>::pop_front() {
+  node* tail = tail_;
+  node* next = tail->right_.load(std::memory_order_acquire);
+  if (tail == &stub_) {
+    if (!next) {
+      return std::nullopt;
+    }
+    tail_ = next;
+    tail = next;
+    next = next->right_.load(std::memory_order_acquire);
+  }
+  if (!next) {
+    if (tail != head_.load(std::memory_order_acquire)) {
+      // a producer has exchanged the head but not linked it yet
+      return std::nullopt;
+    }
+    // tail is the last node, it can only be popped with a successor
+    link(&stub_);
+    next = tail->right_.load(std::memory_order_acquire);
+    if (!next) {
+      return std::nullopt;
+    }
+  }
+  std::optional<T> res(std::move_if_noexcept(tail->value()));
+  tail_ = next;
+  delete static_cast<data_node*>(tail);
+  return res;
+}
+
+template <typename T>
+bool mpsc_list<T>::empty() const noexcept {
+  return tail_ == &stub_ && !stub_.right_.load(std::memory_order_acquire);
+}
+
+template <typename T>
+void mpsc_list<T>::link(node* new_node) noexcept {
+  new_node->right_.store(nullptr, std::memory_order_relaxed);
+  node* prev = head_.exchange(new_node, std::memory_order_acq_rel);
+  prev->right_.store(new_node, std::memory_order_release);
+}
+
+template <typename T>
+T& mpsc_list<T>::node::value() {
+  return static_cast<data_node*>(this)->value_;
+}
+
+template <typename T>
+mpsc_list<T>::data_node::data_node(T const& value) : value_(value) {}
@@ -0,0 +1,164 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// specialize as std::true_type to make list<T> take its nodes from
+// node_cache instead of the global operator new
+template <typename T>
+struct enable_node_cache : std::false_type {};
+
+// free blocks of one size, every thread keeps a local chain of them
+//
+// once a thread holds two magazines worth of free blocks the older
+// magazine goes to a shared lock-free depot, a thread that runs out
+// takes the depot's magazines, so blocks freed by a consumer thread
+// flow back to the producer without a lock, exiting threads leave
+// their blocks in the depot too
+//
+// the depot is never destroyed, and a thread whose local cache is
+// already destroyed goes straight to the global operator new and
+// delete, so lists that outlive the caches (e.g. ones with static
+// storage duration) stay valid
+template <std::size_t Size>
+class node_cache {
+public:
+  // O(1) amortized
+  static void* allocate();
+  // O(1) amortized
+  static void deallocate(void* ptr) noexcept;
+
+private:
+  struct block {
+    block* next_;
+    // the fields below are only meaningful in the first block of a
+    // magazine
+    block* next_magazine_;
+    std::size_t count_;
+  };
+
+  struct local_cache {
+    ~local_cache();
+
+    block* current_{nullptr};
+    std::size_t count_{0};
+    // magazines taken from the depot
+    block* spare_{nullptr};
+  };
+
+  struct depot {
+    std::atomic<block*> head_{nullptr};
+  };
+
+  static constexpr std::size_t block_size = std::max(Size, sizeof(block));
+  static constexpr std::size_t magazine_size = 64;
+
+  // nullptr once the local cache of this thread is destroyed
+  static local_cache* local() noexcept;
+  static bool& local_destroyed() noexcept;
+  static depot& shared() noexcept;
+  static void push_magazine(block* magazine) noexcept;
+};
+
+template <std::size_t Size>
+void* node_cache<Size>::allocate() {
+  local_cache* local_ptr = local();
+  if (!local_ptr) {
+    return ::operator new(block_size);
+  }
+  local_cache& cache = *local_ptr;
+  if (!cache.current_) {
+    if (!cache.spare_) {
+      cache.spare_ =
+          shared().head_.exchange(nullptr, std::memory_order_acquire);
+    }
+    if (!cache.spare_) {
+      return ::operator new(block_size);
+    }
+    cache.current_ = cache.spare_;
+    cache.count_ = cache.spare_->count_;
+    cache.spare_ = cache.spare_->next_magazine_;
+  }
+  block* res = cache.current_;
+  cache.current_ = res->next_;
+  --cache.count_;
+  return res;
+}
+
+template <std::size_t Size>
+void node_cache<Size>::deallocate(void* ptr) noexcept {
+  local_cache* local_ptr = local();
+  if (!local_ptr) {
+    ::operator delete(ptr);
+    return;
+  }
+  local_cache& cache = *local_ptr;
+  block* freed = static_cast<block*>(ptr);
+  freed->next_ = cache.current_;
+  cache.current_ = freed;
+  if (++cache.count_ < 2 * magazine_size) {
+    return;
+  }
+  // keeps the recently freed half, it is more likely to be in cache
+  block* last = cache.current_;
+  for (std::size_t i = 1; i < magazine_size; ++i) {
+    last = last->next_;
+  }
+  block* older = last->next_;
+  last->next_ = nullptr;
+  older->count_ = cache.count_ - magazine_size;
+  cache.count_ = magazine_size;
+  push_magazine(older);
+}
+
+template <std::size_t Size>
+node_cache<Size>::local_cache::~local_cache() {
+  local_destroyed() = true;
+  if (current_) {
+    current_->count_ = count_;
+    push_magazine(current_);
+  }
+  while (spare_) {
+    block* next = spare_->next_magazine_;
+    push_magazine(spare_);
+    spare_ = next;
+  }
+}
+
+template <std::size_t Size>
+typename node_cache<Size>::local_cache* node_cache<Size>::local() noexcept {
+  if (local_destroyed()) {
+    return nullptr;
+  }
+  thread_local local_cache cache;
+  return &cache;
+}
+
+template <std::size_t Size>
+bool& node_cache<Size>::local_destroyed() noexcept {
+  // trivially destructible, so it stays usable after cache is destroyed
+  thread_local bool destroyed = false;
+  return destroyed;
+}
+
+template <std::size_t Size>
+typename node_cache<Size>::depot& node_cache<Size>::shared() noexcept {
+  // never destroyed, local caches and lists may outlive any static, and
+  // placement new keeps this path free of allocations
+  alignas(depot) static unsigned char storage[sizeof(depot)];
+  static depot* instance = new (storage) depot;
+  return *instance;
+}
+
+template <std::size_t Size>
+void node_cache<Size>::push_magazine(block* magazine) noexcept {
+  depot& d = shared();
+  block* head = d.head_.load(std::memory_order_relaxed);
+  do {
+    magazine->next_magazine_ = head;
+  } while (!d.head_.compare_exchange_weak(head, magazine,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+}
@@ -0,0 +1,317 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// read-mostly list, readers traverse it without locks or atomic
+// read-modify-write operations, writers are serialized by a mutex
+//
+// writers publish links with release stores and retire unlinked nodes
+// together with the current epoch, a retired node is freed once every
+// reader inside a read section has announced a later epoch
+//
+// elements are immutable once inserted
+template <typename T>
+class rcu_list {
+private:
+  struct node;
+  struct data_node;
+  struct slot;
+
+public:
+  // per-thread read handle, see make_reader()
+  class reader;
+
+  // O(1)
+  rcu_list() noexcept;
+
+  rcu_list(rcu_list const&) = delete;
+  rcu_list& operator=(rcu_list const&) = delete;
+
+  // O(n)
+  // all readers have to be destroyed
+  ~rcu_list();
+
+  // O(readers)
+  // every reading thread needs its own reader
+  reader make_reader();
+
+  // O(1), strong
+  void push_front(T const&);
+  // O(1), strong
+  void push_back(T const&);
+
+  // O(n + retired nodes + readers), basic
+  // removes the elements satisfying pred, returns their number
+  template <typename Predicate>
+  std::size_t erase_if(Predicate pred);
+
+  // O(n + retired nodes + readers)
+  void clear() noexcept;
+
+private:
+  void retire(node* cur) noexcept;
+  void reclaim() noexcept;
+
+  // first node is head_.right_, the last one has no right_
+  node head_;
+  // last node, written by writers only
+  node* tail_;
+  std::atomic<std::size_t> epoch_{1};
+  // nodes unlinked but possibly still visible to readers
+  node* retired_{nullptr};
+  std::vector<std::unique_ptr<slot>> slots_;
+  // serializes writers and guards retired_ and slots_
+  std::mutex mutex_;
+};
+
+template <typename T>
+struct rcu_list<T>::node {
+  node() = default;
+
+  T& value();
+
+private:
+  std::atomic<node*> right_{nullptr};
+  // written and read by writers only
+  node* left_{nullptr};
+  node* retired_next_{nullptr};
+  std::size_t retired_epoch_{0};
+
+  friend rcu_list;
+};
+
+template <typename T>
+struct rcu_list<T>::data_node : node {
+  explicit data_node(T const& value);
+
+private:
+  T value_;
+
+  friend node;
+};
+
+// epoch announced by one reader, 0 outside of read sections
+template <typename T>
+struct rcu_list<T>::slot {
+  alignas(64) std::atomic<std::size_t> epoch_{0};
+  bool used_{false};
+};
+
+template <typename T>
+class rcu_list<T>::reader {
+public:
+  reader(reader const&) = delete;
+  reader& operator=(reader const&) = delete;
+
+  // O(1)
+  ~reader();
+
+  // O(n), wait-free apart from f
+  // calls f on every element in order, elements erased meanwhile stay
+  // alive until the traversal ends, may be nested
+  template <typename F>
+  void for_each(F f);
+
+private:
+  explicit reader(rcu_list& owner, slot* own) noexcept;
+
+  void enter() noexcept;
+  void leave() noexcept;
+
+  rcu_list* owner_;
+  slot* slot_;
+  std::size_t depth_{0};
+
+  friend rcu_list;
+};
+
+template <typename T>
+rcu_list<T>::rcu_list() noexcept : head_(), tail_(&head_) {}
+
+template <typename T>
+rcu_list<T>::~rcu_list() {
+  node* cur = head_.right_.load(std::memory_order_relaxed);
+  while (cur) {
+    node* next = cur->right_.load(std::memory_order_relaxed);
+    delete static_cast<data_node*>(cur);
+    cur = next;
+  }
+  while (retired_) {
+    node* next = retired_->retired_next_;
+    delete static_cast<data_node*>(retired_);
+    retired_ = next;
+  }
+}
+
+template <typename T>
+typename rcu_list<T>::reader rcu_list<T>::make_reader() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (std::unique_ptr<slot>& s : slots_) {
+    if (!s->used_) {
+      s->used_ = true;
+      return reader(*this, s.get());
+    }
+  }
+  slots_.push_back(std::make_unique<slot>());
+  slots_.back()->used_ = true;
+  return reader(*this, slots_.back().get());
+}
+
+template <typename T>
+void rcu_list<T>::push_front(T const& val) {
+  node* new_node = new data_node(val);
+  std::lock_guard<std::mutex> lock(mutex_);
+  node* right = head_.right_.load(std::memory_order_relaxed);
+  new_node->left_ = &head_;
+  new_node->right_.store(right, std::memory_order_relaxed);
+  if (right) {
+    right->left_ = new_node;
+  } else {
+    tail_ = new_node;
+  }
+  head_.right_.store(new_node, std::memory_order_release);
+}
+
+template <typename T>
+void rcu_list<T>::push_back(T const& val) {
+  node* new_node = new data_node(val);
+  std::lock_guard<std::mutex> lock(mutex_);
+  new_node->left_ = tail_;
+  tail_->right_.store(new_node, std::memory_order_release);
+  tail_ = new_node;
+}
+
+template <typename T>
+template <typename Predicate>
+std::size_t rcu_list<T>::erase_if(Predicate pred) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::size_t count = 0;
+  try {
+    node* cur = head_.right_.load(std::memory_order_relaxed);
+    while (cur) {
+      node* next = cur->right_.load(std::memory_order_relaxed);
+      if (pred(static_cast<T const&>(cur->value()))) {
+        // cur->right_ is kept, readers standing on cur can go on
+        cur->left_->right_.store(next, std::memory_order_release);
+        if (next) {
+          next->left_ = cur->left_;
+        } else {
+          tail_ = cur->left_;
+        }
+        retire(cur);
+        ++count;
+      }
+      cur = next;
+    }
+  } catch (...) {
+    reclaim();
+    throw;
+  }
+  reclaim();
+  return count;
+}
+
+template <typename T>
+void rcu_list<T>::clear() noexcept {
+  std::lock_guard<std::mutex> lock(mutex_);
+  node* cur = head_.right_.load(std::memory_order_relaxed);
+  head_.right_.store(nullptr, std::memory_order_release);
+  tail_ = &head_;
+  while (cur) {
+    node* next = cur->right_.load(std::memory_order_relaxed);
+    retire(cur);
+    cur = next;
+  }
+  reclaim();
+}
+
+template <typename T>
+void rcu_list<T>::retire(node* cur) noexcept {
+  cur->retired_epoch_ = epoch_.load(std::memory_order_relaxed);
+  cur->retired_next_ = retired_;
+  retired_ = cur;
+}
+
+// frees the retired nodes no reader can reach anymore
+template <typename T>
+void rcu_list<T>::reclaim() noexcept {
+  if (!retired_) {
+    return;
+  }
+  // readers announcing a later epoch have seen the unlinking stores
+  epoch_.fetch_add(1, std::memory_order_seq_cst);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::size_t oldest = epoch_.load(std::memory_order_relaxed);
+  for (std::unique_ptr<slot>& s : slots_) {
+    std::size_t e = s->epoch_.load(std::memory_order_acquire);
+    if (e != 0 && e < oldest) {
+      oldest = e;
+    }
+  }
+  node** link = &retired_;
+  while (*link) {
+    node* cur = *link;
+    if (cur->retired_epoch_ < oldest) {
+      *link = cur->retired_next_;
+      delete static_cast<data_node*>(cur);
+    } else {
+      link = &cur->retired_next_;
+    }
+  }
+}
+
+template <typename T>
+T& rcu_list<T>::node::value() {
+  return static_cast<data_node*>(this)->value_;
+}
+
+template <typename T>
+rcu_list<T>::data_node::data_node(T const& value) : value_(value) {}
+
+template <typename T>
+rcu_list<T>::reader::reader(rcu_list& owner, slot* own) noexcept
+    : owner_(&owner), slot_(own) {}
+
+template <typename T>
+rcu_list<T>::reader::~reader() {
+  std::lock_guard<std::mutex> lock(owner_->mutex_);
+  slot_->used_ = false;
+}
+
+template <typename T>
+template <typename F>
+void rcu_list<T>::reader::for_each(F f) {
+  enter();
+  try {
+    node* cur = owner_->head_.right_.load(std::memory_order_acquire);
+    while (cur) {
+      f(static_cast<T const&>(cur->value()));
+      cur = cur->right_.load(std::memory_order_acquire);
+    }
+  } catch (...) {
+    leave();
+    throw;
+  }
+  leave();
+}
+
+template <typename T>
+void rcu_list<T>::reader::enter() noexcept {
+  if (depth_++ == 0) {
+    slot_->epoch_.store(owner_->epoch_.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    // the announcement has to be visible before any node is read
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+}
+
+template <typename T>
+void rcu_list<T>::reader::leave() noexcept {
+  if (--depth_ == 0) {
+    slot_->epoch_.store(0, std::memory_order_release);
+  }
+}
@@ -123,6 +123,12 @@ void faulty_run(std::function<void ()> const& f)
     context = nullptr;
 }
 
+void handled_fault_point()
+{
+    if (context && context->fault_registred)
+        throw injected_fault("handled fault");
+}
+
 fault_injection_disable::fault_injection_disable()
     : was_disabled(disabled)
 {
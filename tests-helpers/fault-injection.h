@@ -11,6 +11,9 @@ struct injected_fault : std::runtime_error
 bool should_inject_fault();
 void fault_injection_point();
 void faulty_run(std::function<void ()> const& f);
+// throws if the code under test caught and handled an injected fault,
+// so that faulty_run goes on to the next one
+void handled_fault_point();
 
 struct fault_injection_disable
 {
@@ -1,6 +1,22 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <gtest/gtest.h>
-
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "augmented-list.h"
+#include "concurrent-list.h"
+#include "indexed-list.h"
 #include "list.h"
+#include "mpsc-list.h"
+#include "rcu-list.h"
 
 #include "tests-helpers/element.h"
 #include "tests-helpers/fault-injection.h"
@@ -873,32 +889,1919 @@ TEST(correctness, clear) {
   expect_eq(c, {5, 6, 7, 8});
 }
 
-TEST(fault_injection, push_back) {
+TEST(correctness, sort) {
   element::no_new_instances_guard g;
-  faulty_run([] {
-    container c;
-    mass_push_back(c, {1, 2, 3, 4});
-  });
+
+  container c;
+  mass_push_back(c, {3, 1, 4, 1, 5, 9, 2, 6});
+  c.sort();
+  expect_eq(c, {1, 1, 2, 3, 4, 5, 6, 9});
 }
 
-TEST(fault_injection, copy_ctor) {
+TEST(correctness, sort_empty) {
   element::no_new_instances_guard g;
-  faulty_run([] {
-    container c;
-    mass_push_back(c, {1, 2, 3, 4});
-    container c2 = c;
-    expect_eq(c2, {1, 2, 3, 4});
-  });
+
+  container c;
+  c.sort();
+  EXPECT_TRUE(c.empty());
+  c.sort_via_index();
+  EXPECT_TRUE(c.empty());
 }
 
-TEST(fault_injection, assignment_operator) {
+TEST(correctness, sort_comparator) {
   element::no_new_instances_guard g;
-  faulty_run([] {
-    container c;
-    mass_push_back(c, {1, 2, 3, 4});
-    container c2;
-    mass_push_back(c2, {5, 6, 7, 8});
-    c2 = c;
-    expect_eq(c2, {1, 2, 3, 4});
+
+  container c;
+  mass_push_back(c, {3, 1, 4, 1, 5, 9, 2, 6});
+  c.sort(std::greater<>());
+  expect_eq(c, {9, 6, 5, 4, 3, 2, 1, 1});
+}
+
+TEST(correctness, sort_stable) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {21, 12, 25, 11, 3, 17});
+  c.sort([](element const& a, element const& b) { return a / 10 < b / 10; });
+  expect_eq(c, {3, 12, 11, 17, 21, 25});
+}
+
+TEST(correctness, sort_iterators) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {4, 3, 2, 1});
+  container::iterator i = c.begin();
+  container::iterator j = std::prev(c.end());
+  c.sort();
+  expect_eq(c, {1, 2, 3, 4});
+  EXPECT_EQ(4, *i);
+  EXPECT_EQ(1, *j);
+  EXPECT_EQ(c.begin(), j);
+  EXPECT_EQ(std::prev(c.end()), i);
+}
+
+TEST(correctness, sort_via_index) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {3, 1, 4, 1, 5, 9, 2, 6});
+  container::iterator i = c.begin();
+  c.sort_via_index();
+  expect_eq(c, {1, 1, 2, 3, 4, 5, 6, 9});
+  expect_reverse_eq(c, {9, 6, 5, 4, 3, 2, 1, 1});
+  EXPECT_EQ(3, *i);
+  EXPECT_EQ(4, *std::next(i));
+}
+
+TEST(correctness, sort_via_index_comparator) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {3, 1, 4, 1, 5, 9, 2, 6});
+  c.sort_via_index(std::greater<>());
+  expect_eq(c, {9, 6, 5, 4, 3, 2, 1, 1});
+}
+
+TEST(correctness, sort_via_index_throwing_comparator) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {3, 1, 4, 1, 5});
+  auto throwing = [](element const&, element const&) -> bool {
+    throw std::runtime_error("comparator");
+  };
+  EXPECT_THROW(c.sort_via_index(throwing), std::runtime_error);
+  expect_eq(c, {3, 1, 4, 1, 5});
+}
+
+int element_key(element const& e) {
+  return e;
+}
+
+TEST(correctness, radix_sort) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {300, -1, 4, 70000, -65536, 0, 2, -300});
+  container::iterator i = c.begin();
+  c.radix_sort(element_key);
+  expect_eq(c, {-65536, -300, -1, 0, 2, 4, 300, 70000});
+  expect_reverse_eq(c, {70000, 300, 4, 2, 0, -1, -300, -65536});
+  EXPECT_EQ(300, *i);
+  EXPECT_EQ(4, *std::prev(i));
+}
+
+TEST(correctness, radix_sort_empty) {
+  element::no_new_instances_guard g;
+
+  container c;
+  c.radix_sort(element_key);
+  EXPECT_TRUE(c.empty());
+}
+
+TEST(correctness, radix_sort_stable) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {21, 12, 25, 11, 3, 17});
+  c.radix_sort([](element const& e) { return unsigned(e / 10); });
+  expect_eq(c, {3, 12, 11, 17, 21, 25});
+}
+
+TEST(correctness, radix_sort_bool_key) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {3, -1, 4, -5, 0, 2});
+  c.radix_sort([](element const& e) { return e > 0; });
+  expect_eq(c, {-1, -5, 0, 3, 4, 2});
+}
+
+TEST(correctness, radix_sort_wide_keys) {
+  list<std::uint64_t> c;
+  mass_push_back(c, {std::uint64_t(1) << 63, std::uint64_t(1) << 40,
+                     std::uint64_t(5), std::uint64_t(0),
+                     (std::uint64_t(1) << 40) + 1});
+  c.radix_sort([](std::uint64_t x) { return x; });
+  expect_eq(c, {std::uint64_t(0), std::uint64_t(5), std::uint64_t(1) << 40,
+                (std::uint64_t(1) << 40) + 1, std::uint64_t(1) << 63});
+}
+
+TEST(correctness, radix_sort_throwing_key) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {3, 1, 4, 1, 5});
+  int calls = 0;
+  auto throwing = [&calls](element const& e) {
+    if (++calls == 3) {
+      throw std::runtime_error("key");
+    }
+    return static_cast<int>(e);
+  };
+  EXPECT_THROW(c.radix_sort(throwing), std::runtime_error);
+  c.sort();
+  expect_eq(c, {1, 1, 3, 4, 5});
+  expect_reverse_eq(c, {5, 4, 3, 1, 1});
+}
+
+TEST(correctness, move_ctor) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {1, 2, 3, 4});
+  container::iterator i = c.begin();
+  container c2 = std::move(c);
+  EXPECT_TRUE(c.empty());
+  expect_eq(c2, {1, 2, 3, 4});
+  EXPECT_EQ(c2.begin(), i);
+}
+
+TEST(correctness, move_assignment) {
+  element::no_new_instances_guard g;
+
+  container c, c2;
+  mass_push_back(c, {1, 2, 3, 4});
+  mass_push_back(c2, {5, 6});
+  c2 = std::move(c);
+  EXPECT_TRUE(c.empty());
+  expect_eq(c2, {1, 2, 3, 4});
+  c2 = container();
+  EXPECT_TRUE(c2.empty());
+}
+
+TEST(correctness, rotate) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {1, 2, 3, 4, 5});
+  container::iterator i = std::next(c.begin(), 2);
+  container::iterator e = c.end();
+  c.rotate(i);
+  expect_eq(c, {3, 4, 5, 1, 2});
+  expect_reverse_eq(c, {2, 1, 5, 4, 3});
+  EXPECT_EQ(c.begin(), i);
+  EXPECT_EQ(c.end(), e);
+  c.rotate(std::prev(c.end()));
+  expect_eq(c, {2, 3, 4, 5, 1});
+}
+
+TEST(correctness, rotate_begin_end) {
+  element::no_new_instances_guard g;
+
+  container c;
+  c.rotate(c.end());
+  EXPECT_TRUE(c.empty());
+  mass_push_back(c, {1, 2, 3});
+  c.rotate(c.begin());
+  expect_eq(c, {1, 2, 3});
+  c.rotate(c.end());
+  expect_eq(c, {1, 2, 3});
+}
+
+TEST(correctness, split) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {1, 2, 3, 4, 5});
+  container::iterator i = std::next(c.begin(), 3);
+  container c2 = c.split(i);
+  expect_eq(c, {1, 2, 3});
+  expect_eq(c2, {4, 5});
+  expect_reverse_eq(c2, {5, 4});
+  EXPECT_EQ(c2.begin(), i);
+}
+
+TEST(correctness, split_begin_end) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {1, 2, 3});
+  container c2 = c.split(c.end());
+  expect_eq(c, {1, 2, 3});
+  EXPECT_TRUE(c2.empty());
+  container c3 = c.split(c.begin());
+  EXPECT_TRUE(c.empty());
+  expect_eq(c3, {1, 2, 3});
+}
+
+TEST(correctness, reverse) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {1, 2, 3, 4, 5});
+  container::iterator i = std::next(c.begin());
+  c.reverse();
+  expect_eq(c, {5, 4, 3, 2, 1});
+  expect_reverse_eq(c, {1, 2, 3, 4, 5});
+  EXPECT_EQ(2, *i);
+  EXPECT_EQ(3, *std::prev(i));
+  EXPECT_EQ(1, *std::next(i));
+  c.insert(i, 6);
+  expect_eq(c, {5, 4, 3, 6, 2, 1});
+}
+
+TEST(correctness, reverse_empty) {
+  element::no_new_instances_guard g;
+
+  container c;
+  c.reverse();
+  EXPECT_TRUE(c.empty());
+  c.push_back(1);
+  c.reverse();
+  expect_eq(c, {1});
+}
+
+bool is_even(element const& e) {
+  return e % 2 == 0;
+}
+
+TEST(correctness, stable_partition) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {1, 2, 3, 4, 5, 6, 7});
+  container::iterator i = c.begin();
+  container::iterator j = std::next(c.begin());
+  container::iterator p = c.stable_partition(is_even);
+  expect_eq(c, {2, 4, 6, 1, 3, 5, 7});
+  expect_reverse_eq(c, {7, 5, 3, 1, 6, 4, 2});
+  EXPECT_EQ(1, *p);
+  EXPECT_EQ(p, i);
+  EXPECT_EQ(c.begin(), j);
+}
+
+TEST(correctness, stable_partition_all_or_none) {
+  element::no_new_instances_guard g;
+
+  container c;
+  EXPECT_EQ(c.end(), c.stable_partition(is_even));
+  mass_push_back(c, {2, 4, 6});
+  EXPECT_EQ(c.end(), c.stable_partition(is_even));
+  expect_eq(c, {2, 4, 6});
+  EXPECT_EQ(c.begin(), c.partition([](element const&) { return false; }));
+  expect_eq(c, {2, 4, 6});
+}
+
+TEST(correctness, split_partition) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {1, 2, 3, 4, 5, 6, 7});
+  container::iterator i = c.begin();
+  container c2 = c.split_partition(is_even);
+  expect_eq(c, {2, 4, 6});
+  expect_eq(c2, {1, 3, 5, 7});
+  expect_reverse_eq(c2, {7, 5, 3, 1});
+  EXPECT_EQ(c2.begin(), i);
+}
+
+TEST(correctness, split_partition_throwing_predicate) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {1, 2, 3, 4, 5});
+  auto throwing = [](element const& e) {
+    if (e == 4) {
+      throw std::runtime_error("predicate");
+    }
+    return e % 2 == 0;
+  };
+  EXPECT_THROW(c.split_partition(throwing), std::runtime_error);
+  expect_eq(c, {2, 4, 5, 1, 3});
+}
+
+TEST(correctness, select_top_k) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {7, 3, 9, 1, 8, 2, 6});
+  container::iterator i = c.begin();
+  c.select_top_k(3);
+  expect_eq(c, {1, 2, 3, 7, 9, 8, 6});
+  expect_reverse_eq(c, {6, 8, 9, 7, 3, 2, 1});
+  EXPECT_EQ(7, *i);
+  EXPECT_EQ(3, *std::prev(i));
+}
+
+TEST(correctness, select_top_k_comparator) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {7, 3, 9, 1, 8, 2, 6});
+  c.select_top_k(2, std::greater<>());
+  expect_eq(c, {9, 8, 7, 3, 1, 2, 6});
+}
+
+TEST(correctness, select_top_k_bounds) {
+  element::no_new_instances_guard g;
+
+  container c;
+  c.select_top_k(5);
+  EXPECT_TRUE(c.empty());
+  mass_push_back(c, {3, 1, 2});
+  c.select_top_k(0);
+  expect_eq(c, {3, 1, 2});
+  c.select_top_k(10);
+  expect_eq(c, {1, 2, 3});
+}
+
+TEST(correctness, nth) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {7, 3, 9, 1, 8, 2, 6});
+  container::iterator i = c.nth(2);
+  EXPECT_EQ(3, *i);
+  EXPECT_EQ(std::next(c.begin(), 2), i);
+  expect_eq(c.begin(), std::next(i), {1, 2, 3});
+  EXPECT_EQ(c.end(), c.nth(7));
+}
+
+TEST(correctness, set_union_into) {
+  element::no_new_instances_guard g;
+
+  container a, b, res;
+  mass_push_back(a, {1, 2, 2, 4, 7});
+  mass_push_back(b, {2, 3, 4, 4, 8});
+  mass_push_back(res, {0});
+  container::iterator i = a.begin();
+  container::iterator j = std::prev(b.end());
+  container::set_union_into(a, b, res);
+  expect_eq(res, {0, 1, 2, 2, 3, 4, 4, 7, 8});
+  expect_reverse_eq(res, {8, 7, 4, 4, 3, 2, 2, 1, 0});
+  EXPECT_TRUE(a.empty());
+  EXPECT_TRUE(b.empty());
+  EXPECT_EQ(std::next(res.begin()), i);
+  EXPECT_EQ(std::prev(res.end()), j);
+}
+
+TEST(correctness, set_intersection_into) {
+  element::no_new_instances_guard g;
+
+  container a, b, res;
+  mass_push_back(a, {1, 2, 2, 4, 7});
+  mass_push_back(b, {2, 3, 4, 4, 8});
+  container::set_intersection_into(a, b, res);
+  expect_eq(res, {2, 4});
+  EXPECT_TRUE(a.empty());
+  EXPECT_TRUE(b.empty());
+}
+
+TEST(correctness, set_difference_into) {
+  element::no_new_instances_guard g;
+
+  container a, b, res;
+  mass_push_back(a, {1, 2, 2, 4, 7});
+  mass_push_back(b, {2, 3, 4, 4, 8});
+  container::set_difference_into(a, b, res);
+  expect_eq(res, {1, 2, 7});
+  EXPECT_TRUE(a.empty());
+  EXPECT_TRUE(b.empty());
+}
+
+TEST(correctness, set_operations_empty) {
+  element::no_new_instances_guard g;
+
+  container a, b, res;
+  mass_push_back(a, {1, 2});
+  container::set_union_into(a, b, res);
+  expect_eq(res, {1, 2});
+  container::set_intersection_into(res, a, b);
+  EXPECT_TRUE(b.empty());
+  EXPECT_TRUE(res.empty());
+  mass_push_back(b, {3, 4});
+  container::set_difference_into(b, a, res);
+  expect_eq(res, {3, 4});
+}
+
+TEST(correctness, set_operations_comparator) {
+  element::no_new_instances_guard g;
+
+  container a, b, res;
+  mass_push_back(a, {7, 4, 2, 1});
+  mass_push_back(b, {8, 4, 3});
+  container::set_union_into(a, b, res, std::greater<>());
+  expect_eq(res, {8, 7, 4, 3, 2, 1});
+}
+
+TEST(correctness, merge_k) {
+  element::no_new_instances_guard g;
+
+  container c, lists[3];
+  mass_push_back(c, {1, 5, 9});
+  mass_push_back(lists[0], {2, 6});
+  mass_push_back(lists[1], {0, 3, 4, 10});
+  mass_push_back(lists[2], {7, 8});
+  container::iterator i = lists[1].begin();
+  c.merge_k(std::begin(lists), std::end(lists));
+  expect_eq(c, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+  expect_reverse_eq(c, {10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0});
+  EXPECT_TRUE(lists[0].empty());
+  EXPECT_TRUE(lists[1].empty());
+  EXPECT_TRUE(lists[2].empty());
+  EXPECT_EQ(c.begin(), i);
+}
+
+TEST(correctness, merge_k_stable) {
+  element::no_new_instances_guard g;
+
+  container c, lists[2];
+  mass_push_back(c, {10, 21});
+  mass_push_back(lists[0], {11, 20});
+  mass_push_back(lists[1], {12, 22});
+  c.merge_k(std::begin(lists), std::end(lists),
+            [](element const& a, element const& b) { return a / 10 < b / 10; });
+  expect_eq(c, {10, 11, 12, 21, 20, 22});
+}
+
+TEST(correctness, merge_k_empty) {
+  element::no_new_instances_guard g;
+
+  container c, lists[2];
+  mass_push_back(lists[1], {1, 2});
+  c.merge_k(std::begin(lists), std::end(lists));
+  expect_eq(c, {1, 2});
+  EXPECT_TRUE(lists[1].empty());
+  c.merge_k(std::begin(lists), std::begin(lists));
+  expect_eq(c, {1, 2});
+}
+
+TEST(correctness, merge_k_repeated) {
+  element::no_new_instances_guard g;
+
+  container c, c1, c2;
+  mass_push_back(c, {1, 4});
+  mass_push_back(c1, {2, 5});
+  mass_push_back(c2, {3, 6});
+  std::vector<std::reference_wrapper<container>> lists = {c1, c, c2, c1, c2};
+  c.merge_k(lists.begin(), lists.end());
+  expect_eq(c, {1, 2, 3, 4, 5, 6});
+  expect_reverse_eq(c, {6, 5, 4, 3, 2, 1});
+  EXPECT_TRUE(c1.empty());
+  EXPECT_TRUE(c2.empty());
+}
+
+TEST(correctness, merge_k_pointers) {
+  element::no_new_instances_guard g;
+
+  container c, c1, c2;
+  mass_push_back(c, {1, 4});
+  mass_push_back(c1, {2, 5});
+  mass_push_back(c2, {3, 6});
+  std::vector<container*> lists = {&c1, &c, &c2, &c1};
+  c.merge_k(lists.begin(), lists.end());
+  expect_eq(c, {1, 2, 3, 4, 5, 6});
+  expect_reverse_eq(c, {6, 5, 4, 3, 2, 1});
+  EXPECT_TRUE(c1.empty());
+  EXPECT_TRUE(c2.empty());
+}
+
+std::size_t element_hash(element const& e) {
+  return std::hash<int>()(e);
+}
+
+TEST(correctness, unique_unsorted) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {3, 1, 3, 2, 1, 1, 4, 2, 5});
+  container::iterator i = std::next(c.begin(), 3);
+  EXPECT_EQ(4, c.unique_unsorted(element_hash));
+  expect_eq(c, {3, 1, 2, 4, 5});
+  expect_reverse_eq(c, {5, 4, 2, 1, 3});
+  EXPECT_EQ(2, *i);
+  EXPECT_EQ(std::next(c.begin(), 2), i);
+}
+
+TEST(correctness, unique_unsorted_no_duplicates) {
+  element::no_new_instances_guard g;
+
+  container c;
+  EXPECT_EQ(0, c.unique_unsorted(element_hash));
+  mass_push_back(c, {5, 4, 3, 2, 1});
+  EXPECT_EQ(0, c.unique_unsorted(element_hash));
+  expect_eq(c, {5, 4, 3, 2, 1});
+}
+
+TEST(correctness, unique_unsorted_equality) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {11, 25, 13, 27, 30});
+  auto tens = [](element const& e) { return std::hash<int>()(e / 10); };
+  auto same_tens = [](element const& a, element const& b) {
+    return a / 10 == b / 10;
+  };
+  EXPECT_EQ(2, c.unique_unsorted(tens, same_tens));
+  expect_eq(c, {11, 25, 30});
+}
+
+TEST(correctness, unique_unsorted_std_hash) {
+  list<int> c;
+  for (int i = 0; i < 1000; ++i) {
+    c.push_back(i % 37);
+  }
+  EXPECT_EQ(963, c.unique_unsorted());
+  int expected = 0;
+  for (int x : c) {
+    EXPECT_EQ(expected++, x);
+  }
+  EXPECT_EQ(37, expected);
+}
+
+TEST(correctness, shuffle) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {1, 2, 3, 4, 5, 6, 7, 8});
+  container::iterator i = c.begin();
+  std::mt19937 rng(42);
+  c.shuffle(rng);
+  EXPECT_EQ(1, *i);
+  c.sort();
+  expect_eq(c, {1, 2, 3, 4, 5, 6, 7, 8});
+  expect_reverse_eq(c, {8, 7, 6, 5, 4, 3, 2, 1});
+  EXPECT_EQ(c.begin(), i);
+}
+
+TEST(correctness, shuffle_permutes) {
+  list<int> c;
+  for (int i = 0; i < 100; ++i) {
+    c.push_back(i);
+  }
+  c.shuffle(std::mt19937(42));
+  int fixed_points = 0;
+  int expected = 0;
+  for (int x : c) {
+    fixed_points += x == expected++;
+  }
+  EXPECT_LT(fixed_points, 100);
+}
+
+TEST(correctness, shuffle_empty) {
+  element::no_new_instances_guard g;
+
+  container c;
+  c.shuffle(std::mt19937(42));
+  EXPECT_TRUE(c.empty());
+}
+
+TEST(correctness, for_each_chunk) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {1, 2, 3, 4, 5, 6, 7});
+  std::vector<std::size_t> sizes;
+  std::vector<int> visited;
+  c.for_each_chunk(
+      [&](element* const* elements, std::size_t count) {
+        sizes.push_back(count);
+        for (std::size_t i = 0; i < count; ++i) {
+          visited.push_back(*elements[i]);
+          *elements[i] = *elements[i] + 1;
+        }
+      },
+      3);
+  EXPECT_EQ((std::vector<std::size_t>{3, 3, 1}), sizes);
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5, 6, 7}), visited);
+  expect_eq(c, {2, 3, 4, 5, 6, 7, 8});
+}
+
+TEST(correctness, for_each_chunk_zero) {
+  list<int> c;
+  mass_push_back(c, {1, 2, 3});
+  std::vector<std::size_t> sizes;
+  c.for_each_chunk(
+      [&sizes](int* const*, std::size_t count) { sizes.push_back(count); },
+      0);
+  EXPECT_EQ((std::vector<std::size_t>{1, 1, 1}), sizes);
+}
+
+TEST(correctness, for_each_chunk_huge) {
+  list<int> c;
+  mass_push_back(c, {1, 2, 3});
+  std::vector<std::size_t> sizes;
+  c.for_each_chunk(
+      [&sizes](int* const*, std::size_t count) { sizes.push_back(count); },
+      SIZE_MAX);
+  EXPECT_EQ((std::vector<std::size_t>{3}), sizes);
+}
+
+TEST(correctness, for_each_chunk_const) {
+  list<double> c;
+  ::as_const(c).for_each_chunk(
+      [](double const* const*, std::size_t) { FAIL(); });
+  for (int i = 1; i <= 100; ++i) {
+    c.push_back(i);
+  }
+  double sum = 0;
+  ::as_const(c).for_each_chunk(
+      [&sum](double const* const* elements, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+          sum += *elements[i];
+        }
+      });
+  EXPECT_EQ(5050, sum);
+}
+
+TEST(correctness, for_each_interleaved) {
+  std::vector<list<int>> lists(20);
+  int expected_sum = 0;
+  for (int i = 0; i < 20; ++i) {
+    for (int j = 0; j < i % 7; ++j) {
+      lists[i].push_back(i * 100 + j);
+      expected_sum += i * 100 + j;
+    }
+  }
+  for (std::size_t group : {0, 1, 3, 8, 50}) {
+    int sum = 0;
+    std::vector<int> last(20, -1);
+    list<int>::for_each_interleaved(
+        lists.begin(), lists.end(),
+        [&](int& x) {
+          sum += x;
+          EXPECT_LT(last[x / 100], x % 100);
+          last[x / 100] = x % 100;
+        },
+        group);
+    EXPECT_EQ(expected_sum, sum);
+  }
+}
+
+TEST(correctness, for_each_interleaved_modify) {
+  element::no_new_instances_guard g;
+
+  container lists[3];
+  mass_push_back(lists[0], {1, 2});
+  mass_push_back(lists[2], {3, 4, 5});
+  container::for_each_interleaved(std::begin(lists), std::end(lists),
+                                  [](element& e) { e = e * 2; }, 2);
+  expect_eq(lists[0], {2, 4});
+  EXPECT_TRUE(lists[1].empty());
+  expect_eq(lists[2], {6, 8, 10});
+}
+
+TEST(correctness, parallel_for_each) {
+  list<int> c;
+  for (int i = 0; i < 1000; ++i) {
+    c.push_back(i);
+  }
+  for (std::size_t threads : {0, 1, 3, 8, 2000}) {
+    parallel_for_each(c, [](int& x) { x += 1; }, threads);
+  }
+  int expected = 5;
+  for (int x : c) {
+    EXPECT_EQ(expected++, x);
+  }
+}
+
+TEST(correctness, parallel_for_each_empty) {
+  list<int> c;
+  parallel_for_each(c, [](int&) { FAIL(); }, 4);
+  EXPECT_TRUE(c.empty());
+}
+
+TEST(correctness, parallel_for_each_exception) {
+  list<int> c;
+  for (int i = 0; i < 100; ++i) {
+    c.push_back(i);
+  }
+  auto throwing = [](int& x) {
+    if (x == 70) {
+      throw std::runtime_error("worker");
+    }
+  };
+  EXPECT_THROW(parallel_for_each(c, throwing, 4), std::runtime_error);
+}
+
+TEST(correctness, parallel_transform_reduce) {
+  list<int> c;
+  EXPECT_EQ(7, parallel_transform_reduce(c, 7, std::plus<>(),
+                                         [](int x) { return x; }, 4));
+  for (int i = 1; i <= 1000; ++i) {
+    c.push_back(i);
+  }
+  for (std::size_t threads : {1, 3, 8}) {
+    long long sum = parallel_transform_reduce(
+        c, 0LL, std::plus<>(), [](int x) { return 1LL * x * x; }, threads);
+    EXPECT_EQ(333833500, sum);
+  }
+  std::string digits = parallel_transform_reduce(
+      c, std::string(), std::plus<>(),
+      [](int x) { return x < 10 ? std::to_string(x) : std::string(); }, 4);
+  EXPECT_EQ("123456789", digits);
+}
+
+TEST(correctness, parallel_copy) {
+  list<std::string> c;
+  for (int i = 0; i < 1000; ++i) {
+    c.push_back(std::to_string(i));
+  }
+  for (std::size_t threads : {0, 1, 3, 8, 2000}) {
+    list<std::string> c2 = list<std::string>::parallel_copy(c, threads);
+    int expected = 0;
+    for (std::string const& x : c2) {
+      EXPECT_EQ(std::to_string(expected++), x);
+    }
+    EXPECT_EQ(1000, expected);
+    EXPECT_EQ("999", c2.back());
+    EXPECT_EQ("998", *std::prev(c2.end(), 2));
+  }
+}
+
+TEST(correctness, parallel_copy_empty) {
+  list<std::string> c;
+  list<std::string> c2 = list<std::string>::parallel_copy(c, 4);
+  EXPECT_TRUE(c2.empty());
+}
+
+struct throwing_copy {
+  static std::atomic<int> instances;
+  static std::atomic<bool> armed;
+
+  explicit throwing_copy(int value) : value(value) {
+    ++instances;
+  }
+  throwing_copy(throwing_copy const& other) : value(other.value) {
+    if (armed && value == 700) {
+      throw std::runtime_error("copy");
+    }
+    ++instances;
+  }
+  ~throwing_copy() {
+    --instances;
+  }
+
+  int value;
+};
+
+std::atomic<int> throwing_copy::instances{0};
+std::atomic<bool> throwing_copy::armed{false};
+
+TEST(correctness, parallel_copy_exception) {
+  {
+    list<throwing_copy> c;
+    for (int i = 0; i < 1000; ++i) {
+      c.push_back(throwing_copy(i));
+    }
+    throwing_copy::armed = true;
+    EXPECT_THROW(list<throwing_copy>::parallel_copy(c, 4),
+                 std::runtime_error);
+    throwing_copy::armed = false;
+    EXPECT_EQ(1000, throwing_copy::instances);
+  }
+  EXPECT_EQ(0, throwing_copy::instances);
+}
+
+TEST(correctness, clear_parallel) {
+  element::no_new_instances_guard g;
+
+  container c;
+  c.clear_parallel(1);
+  EXPECT_TRUE(c.empty());
+  mass_push_back(c, {1, 2, 3, 4});
+  c.clear_parallel(1);
+  EXPECT_TRUE(c.empty());
+  EXPECT_EQ(c.begin(), c.end());
+  mass_push_back(c, {5, 6});
+  expect_eq(c, {5, 6});
+}
+
+TEST(correctness, clear_parallel_threads) {
+  for (std::size_t threads : {0, 1, 3, 8, 2000}) {
+    {
+      list<throwing_copy> c;
+      for (int i = 0; i < 1000; ++i) {
+        c.push_back(throwing_copy(i));
+      }
+      c.clear_parallel(threads);
+      EXPECT_TRUE(c.empty());
+      EXPECT_EQ(0, throwing_copy::instances);
+      c.push_back(throwing_copy(1));
+      EXPECT_EQ(1, c.front().value);
+    }
+    EXPECT_EQ(0, throwing_copy::instances);
+  }
+}
+
+TEST(correctness, build_index) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {10, 20, 30, 40, 50});
+  container::index idx = c.build_index();
+  EXPECT_TRUE(idx.valid());
+  EXPECT_EQ(5, idx.size());
+  EXPECT_EQ(10, *idx.nth(0));
+  EXPECT_EQ(40, *idx.nth(3));
+  EXPECT_EQ(c.end(), idx.nth(5));
+  EXPECT_EQ(std::next(c.begin(), 2), idx.nth(2));
+  EXPECT_EQ(2, idx.position(std::next(c.begin(), 2)));
+  EXPECT_EQ(5, idx.position(c.end()));
+  EXPECT_EQ(3, idx.distance(std::next(c.begin()), std::prev(c.end())));
+  EXPECT_EQ(-4, idx.distance(std::prev(c.end()), c.begin()));
+  EXPECT_EQ(5, idx.distance(c.begin(), c.end()));
+}
+
+TEST(correctness, build_index_empty) {
+  element::no_new_instances_guard g;
+
+  container c;
+  container::index idx = c.build_index();
+  EXPECT_EQ(0, idx.size());
+  EXPECT_EQ(c.end(), idx.nth(0));
+  EXPECT_EQ(0, idx.distance(c.begin(), c.end()));
+}
+
+TEST(correctness, build_index_invalidation) {
+  element::no_new_instances_guard g;
+
+  container c, c2;
+  mass_push_back(c, {1, 2, 3});
+  container::index idx = c.build_index();
+  c.front() = 5;
+  EXPECT_TRUE(idx.valid());
+  c.push_back(4);
+  EXPECT_FALSE(idx.valid());
+
+  idx = c.build_index();
+  c.erase(c.begin());
+  EXPECT_FALSE(idx.valid());
+
+  idx = c.build_index();
+  c2.splice(c2.end(), c, c.begin(), std::next(c.begin()));
+  EXPECT_FALSE(idx.valid());
+
+  idx = c.build_index();
+  container::index idx2 = c2.build_index();
+  c.splice(c.end(), c2, c2.begin(), c2.end());
+  EXPECT_FALSE(idx.valid());
+  EXPECT_FALSE(idx2.valid());
+
+  idx = c.build_index();
+  c.sort();
+  EXPECT_FALSE(idx.valid());
+
+  idx = c.build_index();
+  swap(c, c2);
+  EXPECT_FALSE(idx.valid());
+}
+
+TEST(correctness, finger) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {10, 20, 30, 40, 50, 60});
+  container::finger f = c.make_finger();
+  EXPECT_EQ(10, *f.nth(0));
+  EXPECT_EQ(30, *f.nth(2));
+  EXPECT_EQ(40, *f.nth(3));
+  EXPECT_EQ(20, *f.nth(1));
+  EXPECT_EQ(c.end(), f.nth(6));
+  EXPECT_EQ(60, *f.nth(5));
+  EXPECT_EQ(std::next(c.begin(), 4), f.nth(4));
+  *f.nth(4) = 45;
+  expect_eq(c, {10, 20, 30, 40, 45, 60});
+}
+
+TEST(correctness, finger_empty) {
+  element::no_new_instances_guard g;
+
+  container c;
+  container::finger f = c.make_finger();
+  EXPECT_EQ(c.end(), f.nth(0));
+  c.push_back(1);
+  EXPECT_EQ(1, *f.nth(0));
+  EXPECT_EQ(c.end(), f.nth(1));
+}
+
+TEST(correctness, finger_after_modification) {
+  element::no_new_instances_guard g;
+
+  container c;
+  mass_push_back(c, {1, 2, 3, 4, 5});
+  container::finger f = c.make_finger();
+  EXPECT_EQ(c.end(), f.nth(5));
+  EXPECT_EQ(4, *f.nth(3));
+  c.erase(std::next(c.begin(), 3));
+  c.push_front(0);
+  EXPECT_EQ(3, *f.nth(3));
+  EXPECT_EQ(5, *f.nth(4));
+  EXPECT_EQ(c.end(), f.nth(5));
+  c.reverse();
+  EXPECT_EQ(5, *f.nth(0));
+  EXPECT_EQ(0, *f.nth(4));
+}
+
+TEST(correctness, finger_paging) {
+  list<int> c;
+  for (int i = 0; i < 1000; ++i) {
+    c.push_back(i);
+  }
+  list<int>::finger f = c.make_finger();
+  for (std::size_t page = 0; page < 100; ++page) {
+    for (std::size_t i = page * 10; i < page * 10 + 10; ++i) {
+      EXPECT_EQ(i, *f.nth(i));
+    }
+  }
+  EXPECT_EQ(c.end(), f.nth(1000));
+  for (std::size_t i = 1000; i-- > 0;) {
+    EXPECT_EQ(i, *f.nth(i));
+  }
+}
+
+TEST(fault_injection, push_back) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    container c;
+    mass_push_back(c, {1, 2, 3, 4});
+  });
+}
+
+TEST(fault_injection, copy_ctor) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    container c;
+    mass_push_back(c, {1, 2, 3, 4});
+    container c2 = c;
+    expect_eq(c2, {1, 2, 3, 4});
+  });
+}
+
+TEST(fault_injection, assignment_operator) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    container c;
+    mass_push_back(c, {1, 2, 3, 4});
+    container c2;
+    mass_push_back(c2, {5, 6, 7, 8});
+    c2 = c;
+    expect_eq(c2, {1, 2, 3, 4});
+  });
+}
+
+TEST(fault_injection, sort) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    container c;
+    mass_push_back(c, {3, 1, 4, 1, 5, 9, 2, 6});
+    c.sort();
+    expect_eq(c, {1, 1, 2, 3, 4, 5, 6, 9});
+  });
+}
+
+TEST(fault_injection, sort_via_index) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    container c;
+    mass_push_back(c, {3, 1, 4, 1, 5, 9, 2, 6});
+    c.sort_via_index();
+    expect_eq(c, {1, 1, 2, 3, 4, 5, 6, 9});
+    // a failed allocation of the node array falls back to sort()
+    handled_fault_point();
+  });
+}
+
+TEST(fault_injection, select_top_k) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    container c;
+    mass_push_back(c, {7, 3, 9, 1, 8, 2, 6});
+    try {
+      c.select_top_k(3);
+    } catch (...) {
+      fault_injection_disable dg;
+      expect_eq(c, {7, 3, 9, 1, 8, 2, 6});
+      throw;
+    }
+    expect_eq(c, {1, 2, 3, 7, 9, 8, 6});
+  });
+}
+
+TEST(fault_injection, set_union_into) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    container a, b, res;
+    mass_push_back(a, {1, 2, 4, 7});
+    mass_push_back(b, {2, 3, 4, 8});
+    container::set_union_into(a, b, res);
+    expect_eq(res, {1, 2, 3, 4, 7, 8});
+  });
+}
+
+TEST(fault_injection, merge_k) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    container c, lists[2];
+    mass_push_back(c, {1, 5});
+    mass_push_back(lists[0], {2, 6});
+    mass_push_back(lists[1], {0, 3});
+    c.merge_k(std::begin(lists), std::end(lists));
+    expect_eq(c, {0, 1, 2, 3, 5, 6});
+  });
+}
+
+TEST(fault_injection, unique_unsorted) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    container c;
+    mass_push_back(c, {3, 1, 3, 2, 1});
+    c.unique_unsorted(element_hash);
+    expect_eq(c, {3, 1, 2});
+  });
+}
+
+TEST(indexed_list, push_back_front) {
+  element::no_new_instances_guard g;
+
+  indexed_list<element> c;
+  EXPECT_TRUE(c.empty());
+  EXPECT_EQ(c.begin(), c.end());
+  mass_push_back(c, {3, 4, 5});
+  mass_push_front(c, {2, 1});
+  EXPECT_EQ(5, c.size());
+  expect_eq(c, {1, 2, 3, 4, 5});
+  expect_reverse_eq(c, {5, 4, 3, 2, 1});
+  EXPECT_EQ(1, c.front());
+  EXPECT_EQ(5, c.back());
+  c.pop_front();
+  c.pop_back();
+  expect_eq(c, {2, 3, 4});
+}
+
+TEST(indexed_list, positional_access) {
+  element::no_new_instances_guard g;
+
+  indexed_list<element> c;
+  mass_push_back(c, {10, 20, 30, 40});
+  EXPECT_EQ(30, c.at(2));
+  EXPECT_EQ(10, ::as_const(c).at(0));
+  EXPECT_EQ(c.end(), c.nth(4));
+  EXPECT_EQ(std::next(c.begin(), 3), c.nth(3));
+  EXPECT_EQ(0, c.index_of(c.begin()));
+  EXPECT_EQ(2, c.index_of(std::next(c.begin(), 2)));
+  EXPECT_EQ(4, c.index_of(c.end()));
+  c.at(1) = 25;
+  expect_eq(c, {10, 25, 30, 40});
+}
+
+TEST(indexed_list, insert_erase_at) {
+  element::no_new_instances_guard g;
+
+  indexed_list<element> c;
+  c.insert_at(0, 2);
+  c.insert_at(0, 1);
+  c.insert_at(2, 4);
+  c.insert_at(2, 3);
+  expect_eq(c, {1, 2, 3, 4});
+  EXPECT_EQ(3, *c.erase_at(1));
+  expect_eq(c, {1, 3, 4});
+  EXPECT_EQ(c.end(), c.erase_at(2));
+  expect_eq(c, {1, 3});
+}
+
+TEST(indexed_list, iterators_stability) {
+  element::no_new_instances_guard g;
+
+  indexed_list<element> c;
+  mass_push_back(c, {1, 2, 3, 4, 5});
+  indexed_list<element>::iterator i = std::next(c.begin(), 2);
+  indexed_list<element>::iterator e = c.end();
+  for (int j = 0; j < 50; ++j) {
+    c.insert_at(j % 3, 100 + j);
+    c.push_back(200 + j);
+  }
+  c.erase(c.begin());
+  c.erase(std::prev(c.end()));
+  EXPECT_EQ(3, *i);
+  EXPECT_EQ(c.end(), e);
+  EXPECT_EQ(i, c.nth(c.index_of(i)));
+}
+
+TEST(indexed_list, copy_and_swap) {
+  element::no_new_instances_guard g;
+
+  indexed_list<element> c;
+  mass_push_back(c, {1, 2, 3});
+  indexed_list<element> c2 = c;
+  c2.push_back(4);
+  expect_eq(c, {1, 2, 3});
+  expect_eq(c2, {1, 2, 3, 4});
+  swap(c, c2);
+  expect_eq(c, {1, 2, 3, 4});
+  expect_eq(c2, {1, 2, 3});
+  c2 = std::move(c);
+  EXPECT_TRUE(c.empty());
+  expect_eq(c2, {1, 2, 3, 4});
+  c2.clear();
+  EXPECT_TRUE(c2.empty());
+  c2.push_back(5);
+  expect_eq(c2, {5});
+}
+
+TEST(indexed_list, random_operations) {
+  std::mt19937 rng(42);
+  indexed_list<int> c;
+  std::vector<int> model;
+  for (int step = 0; step < 3000; ++step) {
+    if (model.empty() || rng() % 3 != 0) {
+      std::size_t i = rng() % (model.size() + 1);
+      c.insert_at(i, step);
+      model.insert(model.begin() + i, step);
+    } else {
+      std::size_t i = rng() % model.size();
+      c.erase_at(i);
+      model.erase(model.begin() + i);
+    }
+  }
+  ASSERT_EQ(model.size(), c.size());
+  std::size_t i = 0;
+  for (auto it = c.begin(); it != c.end(); ++it, ++i) {
+    EXPECT_EQ(model[i], *it);
+    EXPECT_EQ(model[i], c.at(i));
+    EXPECT_EQ(i, c.index_of(it));
+  }
+  EXPECT_TRUE(std::equal(model.rbegin(), model.rend(), c.rbegin()));
+}
+
+TEST(fault_injection, indexed_list_copy) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    indexed_list<element> c;
+    mass_push_back(c, {1, 2, 3, 4});
+    indexed_list<element> c2 = c;
+    expect_eq(c2, {1, 2, 3, 4});
+  });
+}
+
+TEST(indexed_list, precedes) {
+  element::no_new_instances_guard g;
+
+  indexed_list<element> c;
+  mass_push_back(c, {1, 2, 3});
+  auto i = c.begin();
+  auto j = std::next(i, 2);
+  EXPECT_TRUE(c.precedes(i, j));
+  EXPECT_FALSE(c.precedes(j, i));
+  EXPECT_FALSE(c.precedes(i, i));
+  EXPECT_TRUE(c.precedes(j, c.end()));
+  EXPECT_FALSE(c.precedes(c.end(), i));
+  auto k = c.insert(j, 5);
+  EXPECT_TRUE(c.precedes(i, k));
+  EXPECT_TRUE(c.precedes(k, j));
+}
+
+TEST(indexed_list, precedes_relabel) {
+  std::mt19937 rng(42);
+  indexed_list<int> c;
+  std::vector<indexed_list<int>::iterator> its;
+  for (int step = 0; step < 2000; ++step) {
+    // crowd insertions into a few spots to exhaust the free labels
+    std::size_t i = step % 4 == 0 ? rng() % (c.size() + 1) : c.size() / 2;
+    its.push_back(c.insert_at(i, step));
+    if (step % 5 == 4) {
+      std::size_t e = rng() % its.size();
+      c.erase(its[e]);
+      its.erase(its.begin() + e);
+    }
+  }
+  for (int step = 0; step < 100; ++step) {
+    its.push_back(c.insert(c.begin(), -step));
+  }
+  for (int step = 0; step < 5000; ++step) {
+    auto a = its[rng() % its.size()];
+    auto b = its[rng() % its.size()];
+    EXPECT_EQ(c.index_of(a) < c.index_of(b), c.precedes(a, b));
+  }
+  for (auto it = c.begin(); std::next(it) != c.end(); ++it) {
+    EXPECT_TRUE(c.precedes(it, std::next(it)));
+  }
+}
+
+struct sum_monoid {
+  using value_type = long long;
+  static value_type identity() {
+    return 0;
+  }
+  static value_type of(int x) {
+    return x;
+  }
+  static value_type combine(value_type a, value_type b) {
+    return a + b;
+  }
+};
+
+struct min_monoid {
+  using value_type = int;
+  static value_type identity() {
+    return INT32_MAX;
+  }
+  static value_type of(int x) {
+    return x;
+  }
+  static value_type combine(value_type a, value_type b) {
+    return std::min(a, b);
+  }
+};
+
+TEST(augmented_list, push_back_front) {
+  element::no_new_instances_guard g;
+
+  augmented_list<element, sum_monoid> c;
+  EXPECT_TRUE(c.empty());
+  EXPECT_EQ(0, c.aggregate());
+  mass_push_back(c, {3, 4, 5});
+  mass_push_front(c, {2, 1});
+  EXPECT_EQ(5, c.size());
+  expect_eq(c, {1, 2, 3, 4, 5});
+  expect_reverse_eq(c, {5, 4, 3, 2, 1});
+  EXPECT_EQ(15, c.aggregate());
+  c.pop_front();
+  c.pop_back();
+  expect_eq(c, {2, 3, 4});
+  EXPECT_EQ(9, c.aggregate());
+}
+
+TEST(augmented_list, aggregate_range) {
+  element::no_new_instances_guard g;
+
+  augmented_list<element, min_monoid> c;
+  mass_push_back(c, {5, 3, 8, 1, 9, 4});
+  EXPECT_EQ(1, c.aggregate());
+  EXPECT_EQ(3, c.aggregate(c.begin(), c.nth(3)));
+  EXPECT_EQ(4, c.aggregate(c.nth(4), c.end()));
+  EXPECT_EQ(8, c.aggregate(c.nth(2), c.nth(3)));
+  EXPECT_EQ(INT32_MAX, c.aggregate(c.nth(2), c.nth(2)));
+  c.assign(c.nth(3), 7);
+  expect_eq(c, {5, 3, 8, 7, 9, 4});
+  EXPECT_EQ(3, c.aggregate());
+  EXPECT_EQ(4, c.aggregate(c.nth(2), c.end()));
+}
+
+// copy assignment that throws after changing the value
+struct throwing_assign {
+  throwing_assign(int value, bool fail = false) : value(value), fail(fail) {}
+  throwing_assign(throwing_assign const&) = default;
+  throwing_assign& operator=(throwing_assign const& other) {
+    value = other.value;
+    if (other.fail) {
+      throw std::runtime_error("assignment failed");
+    }
+    return *this;
+  }
+  operator int() const {
+    return value;
+  }
+
+  int value;
+  bool fail;
+};
+
+TEST(augmented_list, assign_throws) {
+  augmented_list<throwing_assign, sum_monoid> c;
+  for (int i = 1; i <= 5; ++i) {
+    c.push_back(i);
+  }
+  EXPECT_THROW(c.assign(c.nth(2), throwing_assign(10, true)),
+               std::runtime_error);
+  EXPECT_EQ(10, *c.nth(2));
+  EXPECT_EQ(22, c.aggregate());
+  EXPECT_EQ(12, c.aggregate(c.nth(1), c.nth(3)));
+}
+
+TEST(augmented_list, insert_erase) {
+  element::no_new_instances_guard g;
+
+  augmented_list<element, sum_monoid> c;
+  mass_push_back(c, {1, 2, 3, 4, 5});
+  auto i = c.insert(c.nth(2), 10);
+  EXPECT_EQ(10, *i);
+  EXPECT_EQ(2, c.index_of(i));
+  expect_eq(c, {1, 2, 10, 3, 4, 5});
+  EXPECT_EQ(25, c.aggregate());
+  EXPECT_EQ(3, *c.erase(i));
+  auto last = c.nth(3);
+  EXPECT_EQ(last, c.erase(c.nth(1), last));
+  expect_eq(c, {1, 4, 5});
+  EXPECT_EQ(10, c.aggregate());
+  EXPECT_EQ(9, c.aggregate(std::next(c.begin()), c.end()));
+}
+
+TEST(augmented_list, splice) {
+  element::no_new_instances_guard g;
+
+  augmented_list<element, sum_monoid> c1, c2;
+  mass_push_back(c1, {1, 2, 3, 4});
+  mass_push_back(c2, {5, 6, 7, 8});
+  auto i = std::next(c2.begin());
+  c1.splice(c1.nth(2), c2, i, c2.nth(3));
+  expect_eq(c1, {1, 2, 6, 7, 3, 4});
+  expect_eq(c2, {5, 8});
+  EXPECT_EQ(23, c1.aggregate());
+  EXPECT_EQ(13, c2.aggregate());
+  EXPECT_EQ(15, c1.aggregate(c1.nth(1), c1.nth(4)));
+  EXPECT_EQ(6, *i);
+  EXPECT_EQ(2, c1.index_of(i));
+
+  c1.splice(c1.end(), c1, c1.begin(), c1.nth(2));
+  expect_eq(c1, {6, 7, 3, 4, 1, 2});
+  EXPECT_EQ(23, c1.aggregate());
+}
+
+TEST(augmented_list, copy_and_swap) {
+  element::no_new_instances_guard g;
+
+  augmented_list<element, sum_monoid> c;
+  mass_push_back(c, {1, 2, 3});
+  augmented_list<element, sum_monoid> c2 = c;
+  c2.push_back(4);
+  expect_eq(c, {1, 2, 3});
+  expect_eq(c2, {1, 2, 3, 4});
+  swap(c, c2);
+  EXPECT_EQ(10, c.aggregate());
+  EXPECT_EQ(6, c2.aggregate());
+  c2 = std::move(c);
+  EXPECT_TRUE(c.empty());
+  expect_eq(c2, {1, 2, 3, 4});
+  c2.clear();
+  EXPECT_TRUE(c2.empty());
+  EXPECT_EQ(0, c2.aggregate());
+}
+
+TEST(augmented_list, random_operations) {
+  std::mt19937 rng(42);
+  augmented_list<int, min_monoid> c, other;
+  std::vector<int> model;
+  for (int step = 0; step < 3000; ++step) {
+    std::size_t op = rng() % 4;
+    if (model.empty() || op < 2) {
+      std::size_t i = rng() % (model.size() + 1);
+      c.insert(c.nth(i), static_cast<int>(rng() % 100000));
+      model.insert(model.begin() + i, *c.nth(i));
+    } else if (op == 2) {
+      std::size_t i = rng() % model.size();
+      c.erase(c.nth(i));
+      model.erase(model.begin() + i);
+    } else {
+      // move a range out and back to a random spot
+      std::size_t first = rng() % model.size();
+      std::size_t last = first + rng() % (model.size() - first + 1);
+      other.splice(other.end(), c, c.nth(first), c.nth(last));
+      std::vector<int> moved(model.begin() + first, model.begin() + last);
+      model.erase(model.begin() + first, model.begin() + last);
+      std::size_t pos = rng() % (model.size() + 1);
+      c.splice(c.nth(pos), other, other.begin(), other.end());
+      model.insert(model.begin() + pos, moved.begin(), moved.end());
+    }
+    std::size_t first = rng() % (model.size() + 1);
+    std::size_t last = first + rng() % (model.size() - first + 1);
+    int expected = INT32_MAX;
+    for (std::size_t i = first; i < last; ++i) {
+      expected = std::min(expected, model[i]);
+    }
+    ASSERT_EQ(expected, c.aggregate(c.nth(first), c.nth(last)));
+  }
+  ASSERT_EQ(model.size(), c.size());
+  EXPECT_TRUE(other.empty());
+  EXPECT_TRUE(std::equal(model.begin(), model.end(), c.begin()));
+  EXPECT_TRUE(std::equal(model.rbegin(), model.rend(), c.rbegin()));
+}
+
+TEST(fault_injection, augmented_list_copy) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    augmented_list<element, sum_monoid> c;
+    mass_push_back(c, {1, 2, 3, 4});
+    augmented_list<element, sum_monoid> c2 = c;
+    expect_eq(c2, {1, 2, 3, 4});
+    EXPECT_EQ(10, c2.aggregate());
+  });
+}
+
+TEST(mpsc_list, push_pop) {
+  element::no_new_instances_guard g;
+
+  mpsc_list<element> c;
+  EXPECT_TRUE(c.empty());
+  EXPECT_FALSE(c.pop_front());
+  c.push_back(1);
+  EXPECT_FALSE(c.empty());
+  c.push_back(2);
+  c.push_back(3);
+  EXPECT_EQ(1, *c.pop_front());
+  c.push_back(4);
+  EXPECT_EQ(2, *c.pop_front());
+  EXPECT_EQ(3, *c.pop_front());
+  EXPECT_EQ(4, *c.pop_front());
+  EXPECT_TRUE(c.empty());
+  EXPECT_FALSE(c.pop_front());
+  c.push_back(5);
+  EXPECT_EQ(5, *c.pop_front());
+  EXPECT_FALSE(c.pop_front());
+}
+
+TEST(mpsc_list, destroy_non_empty) {
+  element::no_new_instances_guard g;
+
+  mpsc_list<element> c;
+  c.push_back(1);
+  c.push_back(2);
+  c.push_back(3);
+  EXPECT_EQ(1, *c.pop_front());
+}
+
+TEST(mpsc_list, parallel_producers) {
+  constexpr int producers = 8;
+  constexpr int per_producer = 20000;
+  mpsc_list<std::pair<int, int>> c;
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&c, p] {
+      for (int i = 0; i < per_producer; ++i) {
+        c.push_back({p, i});
+      }
+    });
+  }
+  std::vector<int> next(producers, 0);
+  for (int received = 0; received < producers * per_producer;) {
+    std::optional<std::pair<int, int>> item = c.pop_front();
+    if (!item) {
+      std::this_thread::yield();
+      continue;
+    }
+    // every producer's elements arrive in the order they were pushed
+    ASSERT_EQ(next[item->first], item->second);
+    ++next[item->first];
+    ++received;
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  EXPECT_TRUE(c.empty());
+  EXPECT_FALSE(c.pop_front());
+}
+
+TEST(fault_injection, mpsc_list_push_pop) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    mpsc_list<element> c;
+    c.push_back(1);
+    c.push_back(2);
+    EXPECT_EQ(1, *c.pop_front());
+    c.push_back(3);
+    EXPECT_EQ(2, *c.pop_front());
+    EXPECT_EQ(3, *c.pop_front());
+  });
+}
+
+template <typename T>
+std::vector<int> values_of(concurrent_list<T>& c) {
+  std::vector<int> res;
+  c.for_each([&res](T const& val) { res.push_back(val); });
+  return res;
+}
+
+TEST(concurrent_list, push_insert_erase) {
+  element::no_new_instances_guard g;
+
+  concurrent_list<element> c;
+  EXPECT_TRUE(c.empty());
+  c.push_back(2);
+  auto last = c.insert(c.end(), 4);
+  c.push_front(1);
+  auto i = c.insert(last, 3);
+  EXPECT_EQ(3, *i);
+  EXPECT_FALSE(c.empty());
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 4}), values_of(c));
+  EXPECT_EQ(last, c.erase(i));
+  EXPECT_EQ(c.end(), c.erase(last));
+  EXPECT_EQ((std::vector<int>{1, 2}), values_of(c));
+}
+
+TEST(concurrent_list, erase_if) {
+  element::no_new_instances_guard g;
+
+  concurrent_list<element> c;
+  for (int i = 1; i <= 8; ++i) {
+    c.push_back(i);
+  }
+  EXPECT_EQ(4, c.erase_if([](element const& x) { return x % 2 == 0; }));
+  EXPECT_EQ((std::vector<int>{1, 3, 5, 7}), values_of(c));
+  EXPECT_THROW(c.erase_if([](element const& x) {
+    if (x == 5) {
+      throw std::runtime_error("erase_if");
+    }
+    return x == 1;
+  }),
+               std::runtime_error);
+  EXPECT_EQ((std::vector<int>{3, 5, 7}), values_of(c));
+  EXPECT_EQ(3, c.erase_if([](element const&) { return true; }));
+  EXPECT_TRUE(c.empty());
+}
+
+TEST(concurrent_list, for_each_exception) {
+  concurrent_list<int> c;
+  c.push_back(1);
+  c.push_back(2);
+  EXPECT_THROW(c.for_each([](int x) {
+    if (x == 2) {
+      throw std::runtime_error("for_each");
+    }
+  }),
+               std::runtime_error);
+  c.push_back(3);
+  int sum = 0;
+  c.for_each([&sum](int x) { sum += x; });
+  EXPECT_EQ(6, sum);
+}
+
+TEST(concurrent_list, parallel_modification) {
+  constexpr int writers = 4;
+  constexpr int per_writer = 2000;
+  concurrent_list<int> c;
+  auto end = c.end();
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int w = 0; w < writers; ++w) {
+    threads.emplace_back([&c, w] {
+      std::vector<concurrent_list<int>::iterator> mine;
+      for (int i = 0; i < per_writer; ++i) {
+        int val = w * per_writer + i;
+        if (i % 3 == 0) {
+          c.push_front(val);
+        } else if (i % 3 == 1) {
+          mine.push_back(c.insert(c.end(), val));
+        } else {
+          mine.push_back(c.insert(mine.back(), val));
+        }
+      }
+      // odd elements inserted through an iterator are removed again
+      for (auto it : mine) {
+        if (*it % 2 != 0) {
+          c.erase(it);
+        }
+      }
+    });
+  }
+  threads.emplace_back([&c, &done] {
+    while (!done) {
+      long long count = 0;
+      c.for_each([&count](int) { ++count; });
+      EXPECT_LE(count, writers * per_writer);
+    }
+  });
+  for (int w = 0; w < writers; ++w) {
+    threads[w].join();
+  }
+  done = true;
+  threads.back().join();
+
+  EXPECT_EQ(end, c.end());
+  std::vector<int> values = values_of(c);
+  std::vector<int> expected;
+  for (int w = 0; w < writers; ++w) {
+    for (int i = 0; i < per_writer; ++i) {
+      int val = w * per_writer + i;
+      if (i % 3 == 0 || val % 2 == 0) {
+        expected.push_back(val);
+      }
+    }
+  }
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(expected, values);
+}
+
+TEST(concurrent_list, parallel_erase_if) {
+  constexpr int writers = 3;
+  constexpr int per_writer = 3000;
+  concurrent_list<int> c;
+  for (int i = 0; i < 100; ++i) {
+    c.push_back(-i - 1);
+  }
+  std::atomic<int> running{writers};
+  std::vector<std::thread> threads;
+  for (int w = 0; w < writers; ++w) {
+    // writers only erase their own elements, which are positive
+    threads.emplace_back([&c, &running, w] {
+      for (int i = 0; i < per_writer; ++i) {
+        auto it = c.insert(c.end(), w * per_writer + i + 1);
+        if (i % 2 == 0) {
+          c.erase(it);
+        }
+      }
+      --running;
+    });
+  }
+  // the reader erases the negative elements, one per pass
+  threads.emplace_back([&c, &running] {
+    int next = -1;
+    while (running != 0 || next >= -100) {
+      c.erase_if([&next, erased = false](int x) mutable {
+        if (erased || x != next) {
+          return false;
+        }
+        erased = true;
+        --next;
+        return true;
+      });
+    }
+  });
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  std::vector<int> values = values_of(c);
+  std::sort(values.begin(), values.end());
+  std::vector<int> expected;
+  for (int w = 0; w < writers; ++w) {
+    for (int i = 1; i < per_writer; i += 2) {
+      expected.push_back(w * per_writer + i + 1);
+    }
+  }
+  EXPECT_EQ(expected, values);
+}
+
+TEST(fault_injection, concurrent_list_insert) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    concurrent_list<element> c;
+    c.push_back(2);
+    c.push_front(1);
+    c.insert(c.end(), 3);
+    EXPECT_EQ((std::vector<int>{1, 2, 3}), values_of(c));
+  });
+}
+
+template <typename T>
+std::vector<int> values_of(typename rcu_list<T>::reader& r) {
+  std::vector<int> res;
+  r.for_each([&res](T const& val) { res.push_back(val); });
+  return res;
+}
+
+TEST(rcu_list, push_erase_clear) {
+  element::no_new_instances_guard g;
+
+  rcu_list<element> c;
+  rcu_list<element>::reader r = c.make_reader();
+  EXPECT_TRUE(values_of<element>(r).empty());
+  c.push_back(2);
+  c.push_back(3);
+  c.push_front(1);
+  c.push_back(4);
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 4}), values_of<element>(r));
+  EXPECT_EQ(2, c.erase_if([](element const& e) { return e % 2 == 0; }));
+  EXPECT_EQ((std::vector<int>{1, 3}), values_of<element>(r));
+  c.push_back(5);
+  EXPECT_EQ(1, c.erase_if([](element const& e) { return e == 1; }));
+  c.push_front(0);
+  EXPECT_EQ((std::vector<int>{0, 3, 5}), values_of<element>(r));
+  c.clear();
+  EXPECT_TRUE(values_of<element>(r).empty());
+  c.push_back(6);
+  EXPECT_EQ((std::vector<int>{6}), values_of<element>(r));
+}
+
+TEST(rcu_list, erase_during_read) {
+  element::no_new_instances_guard g;
+
+  rcu_list<element> c;
+  mass_push_back(c, {1, 2, 3, 4, 5});
+  rcu_list<element>::reader r = c.make_reader();
+  std::vector<int> seen;
+  r.for_each([&](element const& e) {
+    if (e == 2) {
+      // 2 and 3 are unlinked but have to stay alive until the read ends
+      c.erase_if([](element const& x) { return x == 2 || x == 3; });
+      EXPECT_EQ(2, e);
+      EXPECT_EQ((std::vector<int>{1, 4, 5}), values_of<element>(r));
+    }
+    seen.push_back(e);
+  });
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5}), seen);
+  EXPECT_EQ((std::vector<int>{1, 4, 5}), values_of<element>(r));
+}
+
+TEST(rcu_list, erase_if_exception) {
+  element::no_new_instances_guard g;
+
+  rcu_list<element> c;
+  mass_push_back(c, {1, 2, 3, 4});
+  rcu_list<element>::reader r = c.make_reader();
+  EXPECT_THROW(c.erase_if([](element const& e) {
+    if (e == 3) {
+      throw std::runtime_error("predicate");
+    }
+    return e == 1;
+  }),
+               std::runtime_error);
+  EXPECT_EQ((std::vector<int>{2, 3, 4}), values_of<element>(r));
+}
+
+TEST(rcu_list, parallel_readers) {
+  constexpr int readers = 4;
+  constexpr int rounds = 2000;
+  rcu_list<int> c;
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < readers; ++i) {
+    threads.emplace_back([&c, &done] {
+      rcu_list<int>::reader r = c.make_reader();
+      while (!done) {
+        int prev = -1;
+        r.for_each([&prev](int x) {
+          // the writer keeps the list sorted
+          EXPECT_LT(prev, x);
+          prev = x;
+        });
+      }
+    });
+  }
+  for (int i = 0; i < rounds; ++i) {
+    c.push_back(i);
+    if (i % 4 == 3) {
+      c.erase_if([i](int x) { return x % 2 == 0 || x < i - 100; });
+    }
+  }
+  done = true;
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  rcu_list<int>::reader r = c.make_reader();
+  std::vector<int> expected;
+  for (int i = rounds - 101; i < rounds; i += 2) {
+    expected.push_back(i);
+  }
+  EXPECT_EQ(expected, values_of<int>(r));
+}
+
+TEST(fault_injection, rcu_list_push) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    rcu_list<element> c;
+    c.push_back(2);
+    c.push_front(1);
+    c.push_back(3);
+    rcu_list<element>::reader r = c.make_reader();
+    EXPECT_EQ((std::vector<int>{1, 2, 3}), values_of<element>(r));
+  });
+}
+
+struct cached_element : element {
+  using element::element;
+};
+
+struct cached_pair {
+  int first;
+  long long second;
+};
+
+template <>
+struct enable_node_cache<cached_element> : std::true_type {};
+
+template <>
+struct enable_node_cache<cached_pair> : std::true_type {};
+
+TEST(node_cache, reuse) {
+  element::no_new_instances_guard g;
+
+  list<cached_element> c;
+  mass_push_back(c, {1, 2, 3});
+  std::vector<cached_element const*> addresses;
+  for (cached_element const& e : c) {
+    addresses.push_back(&e);
+  }
+  c.clear();
+  mass_push_back(c, {4, 5, 6});
+  expect_eq(c, {4, 5, 6});
+  for (cached_element const& e : c) {
+    EXPECT_NE(addresses.end(),
+              std::find(addresses.begin(), addresses.end(), &e));
+  }
+  list<cached_element> c2 = c;
+  c2.pop_front();
+  c.splice(c.end(), c2, c2.begin(), c2.end());
+  expect_eq(c, {4, 5, 6, 5, 6});
+}
+
+TEST(node_cache, parallel_producer_consumer) {
+  constexpr int rounds = 50;
+  constexpr int size = 1000;
+  constexpr std::size_t capacity = 2;
+  // lists go from the producer to the consumer, the producer waits while
+  // capacity of them are queued
+  std::deque<list<cached_pair>> queue;
+  std::mutex m;
+  std::condition_variable changed;
+
+  std::vector<cached_pair const*> allocated;
+  std::thread producer([&] {
+    for (int round = 0; round < rounds; ++round) {
+      list<cached_pair> c;
+      for (int i = 0; i < size; ++i) {
+        c.push_back({round, i});
+      }
+      for (cached_pair const& p : c) {
+        allocated.push_back(&p);
+      }
+      std::unique_lock<std::mutex> lock(m);
+      changed.wait(lock, [&] { return queue.size() < capacity; });
+      queue.push_back(std::move(c));
+      changed.notify_all();
+    }
+  });
+  std::thread consumer([&] {
+    for (int round = 0; round < rounds; ++round) {
+      std::unique_lock<std::mutex> lock(m);
+      changed.wait(lock, [&] { return !queue.empty(); });
+      list<cached_pair> c = std::move(queue.front());
+      queue.pop_front();
+      changed.notify_all();
+      lock.unlock();
+      int i = 0;
+      for (cached_pair const& p : c) {
+        EXPECT_EQ(round, p.first);
+        EXPECT_EQ(i++, p.second);
+      }
+      EXPECT_EQ(size, i);
+    }
+  });
+  producer.join();
+  consumer.join();
+
+  // nodes freed by the consumer come back to the producer, so the queue
+  // bound also bounds the number of distinct nodes
+  std::sort(allocated.begin(), allocated.end());
+  std::size_t distinct =
+      std::unique(allocated.begin(), allocated.end()) - allocated.begin();
+  EXPECT_LT(distinct, std::size_t(10 * size));
+}
+
+// destroyed at exit, after the caches of the main thread
+list<cached_pair> static_cached_list;
+
+TEST(node_cache, static_storage_duration) {
+  for (int i = 0; i < 1000; ++i) {
+    static_cached_list.push_back({i, i});
+  }
+  int i = 0;
+  for (cached_pair const& p : static_cached_list) {
+    EXPECT_EQ(i++, p.first);
+  }
+  EXPECT_EQ(1000, i);
+}
+
+TEST(fault_injection, node_cache_copy) {
+  element::no_new_instances_guard g;
+  faulty_run([] {
+    list<cached_element> c;
+    mass_push_back(c, {1, 2, 3, 4});
+    list<cached_element> c2 = c;
+    c.pop_back();
+    c2.push_back(5);
+    expect_eq(c, {1, 2, 3});
+    expect_eq(c2, {1, 2, 3, 4, 5});
   });
 }